@@ -0,0 +1,356 @@
+#ifndef ADAPTIVE_POLICY_HPP
+#define ADAPTIVE_POLICY_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <execution>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Concurrency
+{
+    enum class ExecutionKind
+    {
+        sequenced,
+        parallel,
+        parallel_unsequenced
+    };
+
+    inline constexpr std::array all_execution_kinds = {ExecutionKind::sequenced, ExecutionKind::parallel, ExecutionKind::parallel_unsequenced};
+
+    inline std::string to_string(ExecutionKind kind)
+    {
+        switch (kind)
+        {
+        case ExecutionKind::sequenced:
+            return "seq";
+        case ExecutionKind::parallel:
+            return "par";
+        case ExecutionKind::parallel_unsequenced:
+            return "par_unseq";
+        }
+
+        return "unknown";
+    }
+
+    // calls fun with the standard policy object of the kind
+    template <typename Fun>
+    decltype(auto) visit_policy(ExecutionKind kind, Fun&& fun)
+    {
+        switch (kind)
+        {
+        case ExecutionKind::parallel:
+            return std::forward<Fun>(fun)(std::execution::par);
+        case ExecutionKind::parallel_unsequenced:
+            return std::forward<Fun>(fun)(std::execution::par_unseq);
+        default:
+            return std::forward<Fun>(fun)(std::execution::seq);
+        }
+    }
+
+    namespace Details
+    {
+        // keeps a result that is not used otherwise - e.g. of std::reduce - from being optimized away
+        template <typename T>
+        void escape(const T& value)
+        {
+#if defined(__GNUC__)
+            asm volatile("" : : "r"(&value) : "memory");
+#else
+            static const volatile void* sink;
+            sink = &value;
+#endif
+        }
+    }
+
+    // time of a call for n elements - fitted to two calibration points
+    struct CostModel
+    {
+        double fixed_ns = 0.0;
+        double per_element_ns = 0.0;
+
+        double cost(size_t no_of_elements) const
+        {
+            return fixed_ns + per_element_ns * static_cast<double>(no_of_elements);
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // adaptive execution policy - picks seq/par/par_unseq with the lowest predicted cost for the size of the input
+    // - cost models are calibrated per workload (an algorithm with its operation) and saved in a profile of the machine
+    // - uncalibrated workloads run in parallel from default_parallel_threshold elements if there is more than one core
+
+    class AdaptivePolicy
+    {
+    public:
+        static constexpr size_t default_parallel_threshold = 1 << 15;
+        static constexpr const char* profile_header = "adaptive-profile 1";
+        static constexpr const char* default_profile_file_name = "adaptive_profile.txt";
+
+        struct CalibrationConfig
+        {
+            size_t small_size = 1 << 10;
+            size_t large_size = 1 << 20;
+            size_t no_of_runs = 5; // the fastest run is used - the others are disturbed by the scheduler or cold caches
+        };
+
+        using CostModels = std::array<CostModel, all_execution_kinds.size()>; // indexed by ExecutionKind
+
+    private:
+        mutable std::shared_mutex mtx_models_;
+        std::map<std::string, CostModels, std::less<>> models_;
+        unsigned no_of_cores_ = std::max(1u, std::thread::hardware_concurrency());
+        std::string profile_file_name_ = default_profile_file_name;
+
+        template <typename MakeInput, typename Run>
+        static double fastest_run_ns(ExecutionKind kind, size_t size, size_t no_of_runs, MakeInput& make_input, Run& run)
+        {
+            double fastest = std::numeric_limits<double>::infinity();
+
+            for (size_t i = 0; i < std::max<size_t>(no_of_runs, 1); ++i)
+            {
+                auto input = make_input(size);
+
+                const auto start = std::chrono::steady_clock::now();
+                visit_policy(kind, [&](auto&& policy) {
+                    if constexpr (std::is_void_v<decltype(run(policy, input))>)
+                        run(policy, input);
+                    else
+                        Details::escape(run(policy, input));
+                });
+                const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+                fastest = std::min(fastest, elapsed);
+            }
+
+            return fastest;
+        }
+
+    public:
+        AdaptivePolicy() = default;
+        AdaptivePolicy(const AdaptivePolicy&) = delete;
+        AdaptivePolicy& operator=(const AdaptivePolicy&) = delete;
+
+        ExecutionKind choose(std::string_view workload, size_t size) const
+        {
+            std::shared_lock lk{mtx_models_};
+
+            auto it = models_.find(workload);
+            if (it == models_.end())
+                return no_of_cores_ > 1 && size >= default_parallel_threshold ? ExecutionKind::parallel : ExecutionKind::sequenced;
+
+            const auto& models = it->second;
+            auto best = ExecutionKind::sequenced;
+            for (auto kind : all_execution_kinds)
+                if (models[static_cast<size_t>(kind)].cost(size) < models[static_cast<size_t>(best)].cost(size))
+                    best = kind;
+
+            return best;
+        }
+
+        // fun is called with std::execution::seq, par or par_unseq
+        template <typename Fun>
+        decltype(auto) run(std::string_view workload, size_t size, Fun&& fun) const
+        {
+            return visit_policy(choose(workload, size), std::forward<Fun>(fun));
+        }
+
+        // run(policy, input) is timed for inputs made by make_input(size) - both sizes should fit the typical use
+        template <typename MakeInput, typename Run>
+        void calibrate(const std::string& workload, MakeInput make_input, Run run, const CalibrationConfig& config = {})
+        {
+            if (config.large_size <= config.small_size)
+                throw std::invalid_argument("calibration needs large_size > small_size");
+
+            CostModels models;
+            for (auto kind : all_execution_kinds)
+            {
+                const double small_ns = fastest_run_ns(kind, config.small_size, config.no_of_runs, make_input, run);
+                const double large_ns = fastest_run_ns(kind, config.large_size, config.no_of_runs, make_input, run);
+
+                auto& model = models[static_cast<size_t>(kind)];
+                model.per_element_ns = std::max(0.0, (large_ns - small_ns) / static_cast<double>(config.large_size - config.small_size));
+                model.fixed_ns = std::max(0.0, small_ns - model.per_element_ns * static_cast<double>(config.small_size));
+            }
+
+            set_models(workload, models);
+        }
+
+        void set_models(const std::string& workload, const CostModels& models)
+        {
+            std::unique_lock lk{mtx_models_};
+            models_[workload] = models;
+        }
+
+        std::optional<CostModel> model(std::string_view workload, ExecutionKind kind) const
+        {
+            std::shared_lock lk{mtx_models_};
+
+            if (auto it = models_.find(workload); it != models_.end())
+                return it->second[static_cast<size_t>(kind)];
+            return std::nullopt;
+        }
+
+        bool is_calibrated(std::string_view workload) const
+        {
+            std::shared_lock lk{mtx_models_};
+            return models_.find(workload) != models_.end();
+        }
+
+        void clear()
+        {
+            std::unique_lock lk{mtx_models_};
+            models_.clear();
+        }
+
+        ///////////////////////////////////////////////////////////////
+        // profile - a header with the number of cores, then tab separated lines: workload, kind, fixed ns, ns per element
+
+        void save(std::ostream& out) const
+        {
+            std::shared_lock lk{mtx_models_};
+
+            const auto precision = out.precision(17);
+            out << profile_header << " " << no_of_cores_ << "\n";
+
+            for (const auto& [workload, models] : models_)
+                for (auto kind : all_execution_kinds)
+                {
+                    const auto& model = models[static_cast<size_t>(kind)];
+                    out << workload << "\t" << to_string(kind) << "\t" << model.fixed_ns << "\t" << model.per_element_ns << "\n";
+                }
+
+            out.precision(precision);
+        }
+
+        // throws std::runtime_error for a malformed profile; returns false and keeps the models for a profile of another machine
+        bool load(std::istream& in)
+        {
+            std::string header;
+            unsigned no_of_cores = 0;
+            if (!std::getline(in, header) || header.rfind(profile_header, 0) != 0
+                || !(std::istringstream{header.substr(std::char_traits<char>::length(profile_header))} >> no_of_cores))
+                throw std::runtime_error("not an adaptive policy profile");
+
+            if (no_of_cores != no_of_cores_)
+                return false;
+
+            std::map<std::string, CostModels, std::less<>> models;
+            for (std::string line; std::getline(in, line);)
+            {
+                if (line.empty())
+                    continue;
+
+                std::istringstream fields{line};
+                std::string workload, kind_name;
+                CostModel model;
+                if (!std::getline(fields, workload, '\t') || !std::getline(fields, kind_name, '\t') || !(fields >> model.fixed_ns >> model.per_element_ns))
+                    throw std::runtime_error("malformed line of an adaptive policy profile: " + line);
+
+                auto kind = std::find_if(all_execution_kinds.begin(), all_execution_kinds.end(), [&](auto k) { return to_string(k) == kind_name; });
+                if (kind == all_execution_kinds.end())
+                    throw std::runtime_error("unknown execution policy in an adaptive policy profile: " + kind_name);
+
+                models[workload][static_cast<size_t>(*kind)] = model;
+            }
+
+            std::unique_lock lk{mtx_models_};
+            for (auto& [workload, workload_models] : models)
+                models_[workload] = workload_models;
+
+            return true;
+        }
+
+        // a missing file is not an error - the policy stays uncalibrated and save_profile() creates it
+        bool load_profile(const std::string& file_name)
+        {
+            profile_file_name_ = file_name;
+
+            std::ifstream in{file_name};
+            return in && load(in);
+        }
+
+        void save_profile() const
+        {
+            std::ofstream out{profile_file_name_};
+            if (!out)
+                throw std::runtime_error("cannot write " + profile_file_name_);
+            save(out);
+        }
+
+        const std::string& profile_file_name() const
+        {
+            return profile_file_name_;
+        }
+    };
+
+    inline AdaptivePolicy& adaptive_policy()
+    {
+        static AdaptivePolicy policy;
+        return policy;
+    }
+
+    // the adaptive policy of one workload - e.g. Concurrency::sort(Concurrency::adaptive("sort words"), first, last)
+    // - the name is a view, usually of a literal; no string is built per call
+    struct Adaptive
+    {
+        const AdaptivePolicy& policy;
+        std::string_view workload;
+    };
+
+    inline Adaptive adaptive(std::string_view workload)
+    {
+        return {adaptive_policy(), workload};
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // algorithms with the adaptive policy
+
+    template <typename RandomIt, typename Compare = std::less<>>
+    void sort(const Adaptive& adaptive, RandomIt first, RandomIt last, Compare comp = {})
+    {
+        adaptive.policy.run(adaptive.workload, static_cast<size_t>(std::distance(first, last)),
+            [&](auto&& policy) { std::sort(policy, first, last, comp); });
+    }
+
+    template <typename RandomIt, typename OutputIt, typename UnaryOperation>
+    OutputIt transform(const Adaptive& adaptive, RandomIt first, RandomIt last, OutputIt d_first, UnaryOperation op)
+    {
+        return adaptive.policy.run(adaptive.workload, static_cast<size_t>(std::distance(first, last)),
+            [&](auto&& policy) { return std::transform(policy, first, last, d_first, op); });
+    }
+
+    template <typename RandomIt, typename T, typename BinaryReduceOp, typename UnaryTransformOp>
+    T transform_reduce(const Adaptive& adaptive, RandomIt first, RandomIt last, T init, BinaryReduceOp reduce, UnaryTransformOp transform)
+    {
+        return adaptive.policy.run(adaptive.workload, static_cast<size_t>(std::distance(first, last)),
+            [&](auto&& policy) { return std::transform_reduce(policy, first, last, init, reduce, transform); });
+    }
+
+    template <typename RandomIt, typename Predicate>
+    RandomIt partition(const Adaptive& adaptive, RandomIt first, RandomIt last, Predicate pred)
+    {
+        return adaptive.policy.run(adaptive.workload, static_cast<size_t>(std::distance(first, last)),
+            [&](auto&& policy) { return std::partition(policy, first, last, pred); });
+    }
+}
+
+#endif
@@ -0,0 +1,303 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if __has_include(<malloc.h>)
+#include <malloc.h>
+#define ALLOCATION_COUNTER_HAS_USABLE_SIZE 1
+#endif
+
+namespace Benchmarking
+{
+    namespace
+    {
+        // written only by the owning thread - relaxed load + store instead of a locked add
+        struct alignas(64) ThreadCounters
+        {
+            std::atomic<uint64_t> allocations{0};
+            std::atomic<uint64_t> deallocations{0};
+            std::atomic<uint64_t> bytes_allocated{0};
+        };
+
+        constexpr size_t max_no_of_threads = 256;
+
+        // threads above the limit share the last slot with atomic adds
+        ThreadCounters thread_counters[max_no_of_threads + 1];
+        std::atomic<size_t> no_of_threads{0};
+        thread_local size_t thread_slot = max_no_of_threads + 1;
+
+        std::atomic<bool> is_counting{false};
+
+        // global - a block may be freed by another thread than the one that allocated it; updated only for counted blocks,
+        // so the shared cache line is contended only while allocations are counted
+        std::atomic<int64_t> live{0};
+        std::atomic<int64_t> peak{0};
+
+        void add(std::atomic<uint64_t>& counter, uint64_t value, bool is_shared)
+        {
+            if (is_shared)
+                counter.fetch_add(value, std::memory_order_relaxed);
+            else
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        void add_live(int64_t size)
+        {
+            const int64_t now_live = live.fetch_add(size, std::memory_order_relaxed) + size;
+            int64_t peak_live = peak.load(std::memory_order_relaxed);
+            while (now_live > peak_live && !peak.compare_exchange_weak(peak_live, now_live, std::memory_order_relaxed))
+                ;
+        }
+
+        ThreadCounters& current_thread_counters(bool& is_shared)
+        {
+            if (thread_slot > max_no_of_threads)
+                thread_slot = std::min(no_of_threads.fetch_add(1, std::memory_order_relaxed), max_no_of_threads);
+
+            is_shared = thread_slot == max_no_of_threads;
+            return thread_counters[thread_slot];
+        }
+
+        // blocks carry no header - a header would shift size classes of malloc in every run, counted or not
+        // - live bytes are the usable sizes of blocks, the same when a block is allocated and freed, whichever thread frees it
+        // - without malloc_usable_size the requested size is used, blocks freed by unsized delete are not subtracted
+        size_t block_size(const void* p, size_t size)
+        {
+#ifdef ALLOCATION_COUNTER_HAS_USABLE_SIZE
+            (void)size;
+            return malloc_usable_size(const_cast<void*>(p));
+#else
+            (void)p;
+            return size;
+#endif
+        }
+
+        void count_allocation(size_t size, size_t bytes)
+        {
+            bool is_shared;
+            auto& counters = current_thread_counters(is_shared);
+            add(counters.allocations, 1, is_shared);
+            add(counters.bytes_allocated, size, is_shared);
+            add_live(static_cast<int64_t>(bytes));
+        }
+
+        void count_deallocation(size_t bytes)
+        {
+            bool is_shared;
+            auto& counters = current_thread_counters(is_shared);
+            add(counters.deallocations, 1, is_shared);
+            add_live(-static_cast<int64_t>(bytes));
+        }
+
+        void* try_allocate(size_t size, size_t alignment)
+        {
+            const size_t block = std::max<size_t>(size, 1); // malloc(0) may return nullptr
+
+            void* p = nullptr;
+            if (alignment <= alignof(std::max_align_t))
+                p = std::malloc(block);
+            else
+                p = std::aligned_alloc(alignment, (block + alignment - 1) / alignment * alignment);
+
+            if (p && is_counting.load(std::memory_order_relaxed))
+                count_allocation(size, block_size(p, size));
+
+            return p;
+        }
+
+        void* allocate(size_t size, size_t alignment)
+        {
+            while (true)
+            {
+                if (void* p = try_allocate(size, alignment))
+                    return p;
+
+                auto handler = std::get_new_handler();
+                if (!handler)
+                    throw std::bad_alloc{};
+                handler();
+            }
+        }
+
+        void* allocate(size_t size, size_t alignment, const std::nothrow_t&) noexcept
+        {
+            try
+            {
+                return allocate(size, alignment);
+            }
+            catch (...)
+            {
+                return nullptr;
+            }
+        }
+
+        // size is known for sized delete only
+        void deallocate(void* p, size_t size = 0) noexcept
+        {
+            if (!p)
+                return;
+
+            if (is_counting.load(std::memory_order_relaxed))
+                count_deallocation(block_size(p, size));
+
+            std::free(p);
+        }
+    }
+
+    size_t allocated_block_size(const void* p)
+    {
+        return block_size(p, 0);
+    }
+
+    void start_counting_allocations()
+    {
+        is_counting.store(true, std::memory_order_relaxed);
+    }
+
+    void stop_counting_allocations()
+    {
+        is_counting.store(false, std::memory_order_relaxed);
+    }
+
+    bool is_counting_allocations()
+    {
+        return is_counting.load(std::memory_order_relaxed);
+    }
+
+    AllocationCounts allocation_counts()
+    {
+        AllocationCounts counts;
+
+        for (const auto& counters : thread_counters)
+        {
+            counts.allocations += counters.allocations.load(std::memory_order_relaxed);
+            counts.deallocations += counters.deallocations.load(std::memory_order_relaxed);
+            counts.bytes_allocated += counters.bytes_allocated.load(std::memory_order_relaxed);
+        }
+
+        return counts;
+    }
+
+    int64_t live_bytes()
+    {
+        return live.load(std::memory_order_relaxed);
+    }
+
+    int64_t peak_live_bytes()
+    {
+        return peak.load(std::memory_order_relaxed);
+    }
+
+    void reset_peak_live_bytes()
+    {
+        peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+///////////////////////////////////////////////////////////////
+// replaced global allocation functions
+
+constexpr size_t default_alignment = alignof(std::max_align_t);
+
+void* operator new(std::size_t size)
+{
+    return Benchmarking::allocate(size, default_alignment);
+}
+
+void* operator new[](std::size_t size)
+{
+    return Benchmarking::allocate(size, default_alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return Benchmarking::allocate(size, default_alignment, tag);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return Benchmarking::allocate(size, default_alignment, tag);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return Benchmarking::allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return Benchmarking::allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return Benchmarking::allocate(size, static_cast<size_t>(alignment), tag);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return Benchmarking::allocate(size, static_cast<size_t>(alignment), tag);
+}
+
+void operator delete(void* p) noexcept
+{
+    Benchmarking::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    Benchmarking::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t size) noexcept
+{
+    Benchmarking::deallocate(p, size);
+}
+
+void operator delete[](void* p, std::size_t size) noexcept
+{
+    Benchmarking::deallocate(p, size);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    Benchmarking::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    Benchmarking::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    Benchmarking::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    Benchmarking::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t size, std::align_val_t) noexcept
+{
+    Benchmarking::deallocate(p, size);
+}
+
+void operator delete[](void* p, std::size_t size, std::align_val_t) noexcept
+{
+    Benchmarking::deallocate(p, size);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    Benchmarking::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    Benchmarking::deallocate(p);
+}
@@ -0,0 +1,88 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace Benchmarking
+{
+    ///////////////////////////////////////////////////////////////
+    // counting of dynamic allocations - global operator new/delete are replaced in allocation_counter.cpp
+
+    struct AllocationCounts
+    {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        uint64_t bytes_allocated = 0;
+
+        AllocationCounts& operator+=(const AllocationCounts& other)
+        {
+            allocations += other.allocations;
+            deallocations += other.deallocations;
+            bytes_allocated += other.bytes_allocated;
+            return *this;
+        }
+    };
+
+    inline AllocationCounts operator-(const AllocationCounts& after, const AllocationCounts& before)
+    {
+        return {after.allocations - before.allocations, after.deallocations - before.deallocations, after.bytes_allocated - before.bytes_allocated};
+    }
+
+    // allocations and deallocations are counted only between start and stop - otherwise operator new and delete cost
+    // one relaxed load more; blocks are plain malloc blocks, without headers
+    void start_counting_allocations();
+    void stop_counting_allocations();
+    bool is_counting_allocations();
+
+    // totals of all threads - counters are kept per thread and summed when read (threads above 256 share one slot)
+    AllocationCounts allocation_counts();
+
+    // usable bytes of blocks allocated minus blocks freed while counting - one global counter, blocks may be freed
+    // by other threads; while counting, every allocation and deallocation adds to it and compares with the peak
+    int64_t live_bytes();
+
+    // the highest value of live_bytes() since the last reset
+    int64_t peak_live_bytes();
+    void reset_peak_live_bytes();
+
+    // what a block adds to live_bytes() - its usable size (malloc_usable_size) where the platform provides it
+    size_t allocated_block_size(const void* p);
+
+    ///////////////////////////////////////////////////////////////
+    // collecting allocations of Catch benchmarks
+
+    // allocations of one benchmark accumulated over all of its runs
+    struct AllocationSample
+    {
+        AllocationCounts counts;
+        uint64_t runs = 0;
+        int64_t peak_live_bytes = 0; // above the live bytes from before a measurement
+
+        double allocations_per_run() const
+        {
+            return runs > 0 ? static_cast<double>(counts.allocations) / static_cast<double>(runs) : 0.0;
+        }
+
+        double bytes_per_run() const
+        {
+            return runs > 0 ? static_cast<double>(counts.bytes_allocated) / static_cast<double>(runs) : 0.0;
+        }
+    };
+
+    struct AllocationRecorder
+    {
+        bool is_enabled = false;                 // set by --allocations
+        std::optional<AllocationSample> current; // reset by the results listener when a benchmark starts
+    };
+
+    inline AllocationRecorder& allocation_recorder()
+    {
+        static AllocationRecorder recorder;
+        return recorder;
+    }
+}
+
+#endif
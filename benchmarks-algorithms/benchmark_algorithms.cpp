@@ -2,15 +2,42 @@
 #include "catch.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <boost/algorithm/string.hpp>
 #include <cmath>
 #include <execution>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <random>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "adaptive_policy.hpp"
+#include "case_folding.hpp"
+#include "concurrent_hash_map.hpp"
+#include "corpus.hpp"
+#include "count_min_sketch.hpp"
+#include "counter_rng.hpp"
+#include "datasets.hpp"
+#include "fixtures.hpp"
+#include "hashing.hpp"
+#include "hyperloglog.hpp"
+#include "instrumentation.hpp"
+#include "primes.hpp"
+#include "radix_sort.hpp"
+#include "scaling_sweep.hpp"
+#include "sort_by_key.hpp"
+#include "space_saving.hpp"
+#include "thread_pool.hpp"
+#include "token_column.hpp"
+#include "tracer.hpp"
+#include "word_count.hpp"
 
 using DocumentContent = std::vector<std::string>;
 
@@ -31,16 +58,82 @@ std::optional<DocumentContent> load_words(const std::string &file_name)
     return words;
 }
 
-inline const DocumentContent words = [] { DocumentContent words = load_words("tokens.txt").value(); words.resize(words.size() / 10);  return words; }();
+DocumentContent to_document_content(const Corpus::TokenViews &tokens)
+{
+    return DocumentContent(tokens.begin(), tokens.end());
+}
+
+// built on first use - a run filtered to test cases that do not need the corpus does not load it
+// - the mapped corpus and its views need no allocation per token; only "words" owns a std::string per token
+const Benchmarking::RegisterFixture<Corpus::MappedCorpus> corpus_fixture{"corpus", [] {
+    return Corpus::load_words_mapped("tokens.txt").value();
+}};
+
+// a tenth of the corpus - the input of the benchmarks
+const Benchmarking::RegisterFixture<Corpus::TokenViews> word_views_fixture{"word views", [] {
+    const auto &corpus = Benchmarking::fixture<Corpus::MappedCorpus>("corpus");
+    return Corpus::TokenViews(corpus.begin(), corpus.begin() + static_cast<std::ptrdiff_t>(corpus.size() / 10));
+}};
+
+const Benchmarking::RegisterFixture<DocumentContent> words_fixture{"words", [] {
+    return to_document_content(Benchmarking::fixture<Corpus::TokenViews>("word views"));
+}};
+
+const Benchmarking::RegisterFixture<Corpus::TokenColumn> words_column_fixture{"words column", [] {
+    const auto &word_views = Benchmarking::fixture<Corpus::TokenViews>("word views");
+    return Corpus::TokenColumn{word_views.begin(), word_views.end()};
+}};
 
 TEST_CASE("hardware concurrency")
 {
     std::cout << "No of cores: " << std::thread::hardware_concurrency() << "\n";
-    std::cout << "No of words: " << words.size() << std::endl;
+    std::cout << "No of thread pool workers: " << Concurrency::ThreadPool::shared().size() << "\n";
+    std::cout << "Fixtures:";
+    for (const auto &name : Benchmarking::fixtures().names())
+        std::cout << " " << name << (Benchmarking::fixtures().is_built(name) ? "" : " (not built)");
+    std::cout << std::endl;
+}
+
+TEST_CASE("load words")
+{
+    REQUIRE(to_document_content(Corpus::load_words_mapped("tokens.txt").value().tokens()) == load_words("tokens.txt").value());
+
+    BENCHMARK("ifstream >> std::string")
+    {
+        Benchmarking::ScopedSpan span{"load words - ifstream"};
+        return load_words("tokens.txt").value().size();
+    };
+
+    BENCHMARK("mmap + std::string_view")
+    {
+        Benchmarking::ScopedSpan span{"load words - mmap"};
+        return Corpus::load_words_mapped("tokens.txt").value().size();
+    };
+}
+
+TEST_CASE("tokenize")
+{
+    const auto file = Corpus::MappedFile::open("tokens.txt").value();
+    const auto text = file.content();
+
+    REQUIRE(Corpus::tokenize_parallel(text) == Corpus::tokenize(text));
+
+    BENCHMARK("sequenced")
+    {
+        return Corpus::tokenize(text).size();
+    };
+
+    BENCHMARK("parallel chunks")
+    {
+        return Corpus::tokenize_parallel(text).size();
+    };
 }
 
 TEST_CASE("accumulate")
 {
+    const auto &words = Benchmarking::fixture<DocumentContent>("words");
+    const auto &words_column = Benchmarking::fixture<Corpus::TokenColumn>("words column");
+
     auto calc_hash = [](const auto &item) { return std::hash<std::remove_cv_t<std::remove_reference_t<decltype(item)>>>{}(item); };
 
     BENCHMARK("std::accumulate")
@@ -57,17 +150,368 @@ TEST_CASE("accumulate")
     {
         return std::transform_reduce(std::execution::par_unseq, words.begin(), words.end(), 0ULL, std::plus{}, calc_hash);
     };
+
+    BENCHMARK("thread pool - parallel_reduce")
+    {
+        return Concurrency::parallel_reduce(Concurrency::ThreadPool::shared(), words.begin(), words.end(), 0ULL, std::plus{}, calc_hash);
+    };
+
+    REQUIRE(std::accumulate(words_column.begin(), words_column.end(), 0ULL, [=](const auto &total, const auto &word) { return total + calc_hash(word); })
+        == std::accumulate(words.begin(), words.end(), 0ULL, [=](const auto &total, const auto &word) { return total + calc_hash(word); }));
+
+    BENCHMARK("TokenColumn - std::accumulate")
+    {
+        return std::accumulate(words_column.begin(), words_column.end(), 0ULL, [=](const auto &total, const auto &word) { return total + calc_hash(word); });
+    };
+
+    BENCHMARK("TokenColumn - std::transform_reduce - parallel")
+    {
+        return std::transform_reduce(std::execution::par, words_column.begin(), words_column.end(), 0ULL, std::plus{}, calc_hash);
+    };
+
+    // the same reductions with pluggable hashers - std::hash<std::string> of libstdc++ is Murmur2 reading a byte at a time at the tail
+    const Hashing::WyHash wyhash;
+
+    BENCHMARK("wyhash - std::accumulate")
+    {
+        return std::accumulate(words.begin(), words.end(), 0ULL, [=](const auto &total, const auto &word) { return total + wyhash(word); });
+    };
+
+    BENCHMARK("wyhash - std::transform_reduce - parallel")
+    {
+        return std::transform_reduce(std::execution::par, words.begin(), words.end(), 0ULL, std::plus{}, [=](const auto &word) { return wyhash(word); });
+    };
+
+    BENCHMARK("fnv1a - std::accumulate")
+    {
+        const Hashing::Fnv1a fnv1a;
+        return std::accumulate(words.begin(), words.end(), 0ULL, [=](const auto &total, const auto &word) { return total + fnv1a(word); });
+    };
+
+    BENCHMARK("TokenColumn - wyhash - bulk")
+    {
+        const auto hashes = Hashing::hash_tokens(words_column, wyhash);
+        return std::accumulate(hashes.begin(), hashes.end(), 0ULL);
+    };
+
+    BENCHMARK("TokenColumn - wyhash - bulk parallel")
+    {
+        const auto hashes = Hashing::hash_tokens(std::execution::par, words_column, wyhash);
+        return std::reduce(std::execution::par, hashes.begin(), hashes.end(), 0ULL);
+    };
+}
+
+TEST_CASE("word count")
+{
+    const auto &words = Benchmarking::fixture<DocumentContent>("words");
+    const auto &words_column = Benchmarking::fixture<Corpus::TokenColumn>("words column");
+
+    BENCHMARK("std::unordered_map<std::string>")
+    {
+        std::unordered_map<std::string, uint64_t> counts;
+        for (const auto &word : words)
+            ++counts[word];
+        return counts.size();
+    };
+
+    BENCHMARK("std::execution::par + mutex")
+    {
+        std::unordered_map<std::string_view, uint64_t> counts;
+        std::mutex mtx_counts;
+
+        std::for_each(std::execution::par, words.begin(), words.end(), [&](const auto &word) {
+            std::lock_guard lk{mtx_counts};
+            ++counts[word];
+        });
+
+        return counts.size();
+    };
+
+    BENCHMARK("count_words - sequenced")
+    {
+        return Corpus::count_words(words.begin(), words.end()).size();
+    };
+
+    BENCHMARK("count_words - thread pool")
+    {
+        return Corpus::count_words(Concurrency::ThreadPool::shared(), words.begin(), words.end()).size();
+    };
+
+    BENCHMARK("count_words - thread pool - TokenColumn")
+    {
+        return Corpus::count_words(Concurrency::ThreadPool::shared(), words_column.begin(), words_column.end()).size();
+    };
+
+    BENCHMARK("count_words - thread pool - by frequency")
+    {
+        return Corpus::count_words_by_frequency(Concurrency::ThreadPool::shared(), words.begin(), words.end()).front().count;
+    };
+
+    BENCHMARK("count_words - thread pool - top 100")
+    {
+        return Corpus::count_words_by_frequency(Concurrency::ThreadPool::shared(), words.begin(), words.end(), 100).front().count;
+    };
+}
+
+// one shared vocabulary built by 1..N writers - hidden, the number of writer threads may exceed the number of cores
+TEST_CASE("shared vocabulary", "[.][concurrent]")
+{
+    const auto &words = Benchmarking::fixture<DocumentContent>("words");
+
+    // writer w counts the w-th chunk of words
+    auto run_writers = [&](size_t no_of_writers, auto count_word) {
+        std::vector<std::thread> writers;
+        for (size_t w = 0; w < no_of_writers; ++w)
+        {
+            writers.emplace_back([&, w] {
+                const auto chunk_last = words.begin() + static_cast<std::ptrdiff_t>((w + 1) * words.size() / no_of_writers);
+                for (auto it = words.begin() + static_cast<std::ptrdiff_t>(w * words.size() / no_of_writers); it != chunk_last; ++it)
+                    count_word(*it);
+            });
+        }
+
+        for (auto &writer : writers)
+            writer.join();
+    };
+
+    const size_t max_writers = std::max<size_t>(4, std::thread::hardware_concurrency());
+
+    for (size_t no_of_writers = 1; no_of_writers <= max_writers; no_of_writers *= 2)
+    {
+        BENCHMARK("std::mutex + std::unordered_map - " + std::to_string(no_of_writers) + " writers")
+        {
+            std::unordered_map<std::string, uint64_t> counts;
+            std::mutex mtx_counts;
+
+            run_writers(no_of_writers, [&](const std::string &word) {
+                std::lock_guard lk{mtx_counts};
+                ++counts[word];
+            });
+
+            return counts.size();
+        };
+
+        BENCHMARK("ShardedHashMap - " + std::to_string(no_of_writers) + " writers")
+        {
+            Concurrency::ShardedHashMap<uint64_t> counts;
+
+            run_writers(no_of_writers, [&](const std::string &word) { counts.insert_or_update(word, 1, [](uint64_t &count) { ++count; }); });
+
+            return counts.size();
+        };
+    }
+
+    // readers query the table while it is being built
+    BENCHMARK("ShardedHashMap - writers + readers")
+    {
+        Concurrency::ShardedHashMap<uint64_t> counts;
+        std::atomic<bool> is_done{false};
+
+        std::thread reader{[&] {
+            size_t no_of_hits = 0;
+            while (!is_done.load(std::memory_order_relaxed))
+                no_of_hits += counts.contains(words.front());
+            return no_of_hits;
+        }};
+
+        run_writers(2, [&](const std::string &word) { counts.insert_or_update(word, 1, [](uint64_t &count) { ++count; }); });
+
+        is_done = true;
+        reader.join();
+
+        return counts.size();
+    };
+}
+
+///////////////////////////////////////////////////////////////
+// approximate counting in bounded memory - tokens are streamed from the file like in load_words()
+
+namespace
+{
+    template <typename Func>
+    void for_each_token(const std::string &file_name, Func f)
+    {
+        std::ifstream input_file{file_name};
+
+        for (std::string token; input_file >> token;)
+            f(token);
+    }
+}
+
+TEST_CASE("count-min sketch & space-saving - accuracy vs. memory", "[.][sketches]")
+{
+    std::unordered_map<std::string, uint64_t> exact_counts;
+    for_each_token("tokens.txt", [&](const std::string &token) { ++exact_counts[token]; });
+
+    std::vector<std::pair<std::string, uint64_t>> exact_top(exact_counts.begin(), exact_counts.end());
+    std::sort(exact_top.begin(), exact_top.end(), [](const auto &a, const auto &b) { return a.second != b.second ? a.second > b.second : a.first < b.first; });
+    const size_t k = std::min<size_t>(100, exact_top.size());
+
+    std::cout << "Tokens: " << std::accumulate(exact_counts.begin(), exact_counts.end(), 0ULL, [](auto total, const auto &entry) { return total + entry.second; })
+              << ", distinct: " << exact_counts.size() << "\n\n";
+
+    std::cout << "count-min sketch (depth 4)\n"
+              << std::setw(8) << "width" << std::setw(12) << "memory [B]" << std::setw(16) << "mean abs error" << std::setw(12) << "max error"
+              << std::setw(20) << "top-" << k << " max rel error\n";
+
+    for (size_t width : {256, 1024, 4096, 16384, 65536})
+    {
+        Sketches::CountMinSketch sketch{width, 4};
+        for_each_token("tokens.txt", [&](const std::string &token) { sketch.add(token); });
+
+        double total_error = 0.0;
+        uint64_t max_error = 0;
+        for (const auto &[word, count] : exact_counts)
+        {
+            const uint64_t error = sketch.estimate(word) - count;
+            total_error += static_cast<double>(error);
+            max_error = std::max(max_error, error);
+        }
+
+        double max_top_relative_error = 0.0;
+        for (size_t i = 0; i < k; ++i)
+            max_top_relative_error = std::max(max_top_relative_error, static_cast<double>(sketch.estimate(exact_top[i].first) - exact_top[i].second) / exact_top[i].second);
+
+        std::cout << std::setw(8) << width << std::setw(12) << sketch.memory_bytes() << std::setw(16) << total_error / exact_counts.size()
+                  << std::setw(12) << max_error << std::setw(24) << max_top_relative_error << "\n";
+    }
+
+    std::cout << "\nspace-saving\n"
+              << std::setw(10) << "capacity" << std::setw(12) << "memory [B]" << std::setw(8) << "top-" << k << " recall" << std::setw(22) << "max rel error\n";
+
+    for (size_t capacity : {128, 256, 1024, 4096})
+    {
+        Sketches::SpaceSaving top_k{capacity};
+        for_each_token("tokens.txt", [&](const std::string &token) { top_k.add(token); });
+
+        std::unordered_set<std::string> exact_keys;
+        for (size_t i = 0; i < k; ++i)
+            exact_keys.insert(exact_top[i].first);
+
+        size_t no_of_hits = 0;
+        double max_relative_error = 0.0;
+        for (const auto &counter : top_k.top(k))
+        {
+            no_of_hits += exact_keys.count(counter.key);
+            const auto exact = exact_counts.at(counter.key);
+            max_relative_error = std::max(max_relative_error, static_cast<double>(counter.count - exact) / exact);
+        }
+
+        std::cout << std::setw(10) << capacity << std::setw(12) << top_k.memory_bytes() << std::setw(15) << static_cast<double>(no_of_hits) / k
+                  << std::setw(21) << max_relative_error << "\n";
+    }
+
+    std::cout << std::endl;
+}
+
+TEST_CASE("count-min sketch & space-saving", "[.][sketches]")
+{
+    const auto &words = Benchmarking::fixture<Corpus::TokenViews>("word views");
+
+    BENCHMARK("exact - std::unordered_map")
+    {
+        std::unordered_map<std::string_view, uint64_t, Hashing::WyHash> counts;
+        for (const auto &word : words)
+            ++counts[word];
+        return counts.size();
+    };
+
+    BENCHMARK("count-min sketch - 4 x 4096")
+    {
+        Sketches::CountMinSketch sketch{4096, 4};
+        for (const auto &word : words)
+            sketch.add(word);
+        return sketch.estimate(words.front());
+    };
+
+    BENCHMARK("space-saving - 256")
+    {
+        Sketches::SpaceSaving top_k{256};
+        for (const auto &word : words)
+            top_k.add(word);
+        return top_k.min_count();
+    };
+
+    // a sketch per chunk, merged at the end
+    BENCHMARK("count-min sketch + space-saving - thread pool - merged")
+    {
+        auto &pool = Concurrency::ThreadPool::shared();
+        const size_t no_of_chunks = pool.size();
+
+        std::vector<Sketches::CountMinSketch> sketches(no_of_chunks, Sketches::CountMinSketch{4096, 4});
+        std::vector<Sketches::SpaceSaving> top_ks(no_of_chunks, Sketches::SpaceSaving{256});
+
+        Concurrency::parallel_for(pool, size_t{0}, no_of_chunks, [&](size_t chunk) {
+            for (size_t i = chunk * words.size() / no_of_chunks; i < (chunk + 1) * words.size() / no_of_chunks; ++i)
+            {
+                sketches[chunk].add(words[i]);
+                top_ks[chunk].add(words[i]);
+            }
+        }, 1);
+
+        for (size_t chunk = 1; chunk < no_of_chunks; ++chunk)
+        {
+            sketches.front().merge(sketches[chunk]);
+            top_ks.front().merge(top_ks[chunk]);
+        }
+
+        return top_ks.front().top(10).front().count;
+    };
+}
+
+TEST_CASE("hyperloglog - distinct tokens vs. std::unordered_set", "[.][sketches]")
+{
+    std::unordered_set<std::string> exact;
+    for_each_token("tokens.txt", [&](const std::string &token) { exact.insert(token); });
+
+    std::cout << "Distinct tokens: " << exact.size() << "\n\n"
+              << std::setw(10) << "precision" << std::setw(12) << "memory [B]" << std::setw(12) << "serialized" << std::setw(12) << "estimate"
+              << std::setw(12) << "error [%]" << std::setw(16) << "std error [%]\n";
+
+    for (uint8_t precision : {8, 10, 12, 14, 16})
+    {
+        Sketches::HyperLogLog<> sketch{precision};
+        for_each_token("tokens.txt", [&](const std::string &token) { sketch.add(token); });
+
+        const auto estimate = sketch.estimate();
+        std::cout << std::setw(10) << static_cast<unsigned>(precision) << std::setw(12) << sketch.memory_bytes() << std::setw(12) << sketch.serialize().size()
+                  << std::setw(12) << estimate << std::setw(12) << 100.0 * (static_cast<double>(estimate) - exact.size()) / exact.size()
+                  << std::setw(15) << 100.0 * sketch.standard_error() << "\n";
+    }
+
+    std::cout << std::endl;
+
+    const auto &words = Benchmarking::fixture<Corpus::TokenViews>("word views");
+
+    BENCHMARK("exact - std::unordered_set")
+    {
+        std::unordered_set<std::string_view, Hashing::WyHash> distinct(words.begin(), words.end());
+        return distinct.size();
+    };
+
+    BENCHMARK("hyperloglog - 16 KB")
+    {
+        return Sketches::count_distinct(words.begin(), words.end()).estimate();
+    };
+
+    BENCHMARK("hyperloglog - 16 KB - thread pool - merged")
+    {
+        return Sketches::count_distinct(Concurrency::ThreadPool::shared(), words.begin(), words.end()).estimate();
+    };
 }
 
 TEST_CASE("sort")
 {
+    const auto &words = Benchmarking::fixture<DocumentContent>("words");
+    const auto &words_column = Benchmarking::fixture<Corpus::TokenColumn>("words column");
+
     BENCHMARK_ADVANCED("sequenced")
     (Catch::Benchmark::Chronometer meter)
     {
         auto words_to_sort = words;
         REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
 
-        meter.measure([&] {
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
             std::sort(
                 words_to_sort.begin(), words_to_sort.end(),
                 [](const auto &a, const auto &b) { return boost::to_lower_copy(a) < boost::to_lower_copy(b); });
@@ -81,7 +525,7 @@ TEST_CASE("sort")
         auto words_to_sort = words;
         REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
 
-        meter.measure([&] {
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
             std::sort(
                 std::execution::par,
                 words_to_sort.begin(), words_to_sort.end(),
@@ -91,16 +535,124 @@ TEST_CASE("sort")
         });
     };
 
-    BENCHMARK_ADVANCED("parallel unsequenced")
+    BENCHMARK_ADVANCED("thread pool - parallel_sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto words_to_sort = words;
+        REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
+
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
+            Concurrency::parallel_sort(
+                Concurrency::ThreadPool::shared(),
+                words_to_sort.begin(), words_to_sort.end(),
+                [](const auto &a, const auto &b) { return boost::to_lower_copy(a) < boost::to_lower_copy(b); });
+
+            return words_to_sort.front();
+        });
+    };
+
+    BENCHMARK_ADVANCED("sort_by_key - sequenced")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto words_to_sort = words;
+        REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
+
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
+            Algorithms::sort_by_key(
+                words_to_sort.begin(), words_to_sort.end(),
+                [](const auto &w) { return boost::to_lower_copy(w); });
+            return words_to_sort.front();
+        });
+    };
+
+    BENCHMARK_ADVANCED("sort_by_key - parallel")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto words_to_sort = words;
+        REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
+
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
+            Algorithms::sort_by_key(
+                std::execution::par,
+                words_to_sort.begin(), words_to_sort.end(),
+                [](const auto &w) { return boost::to_lower_copy(w); });
+            return words_to_sort.front();
+        });
+    };
+
+    BENCHMARK_ADVANCED("radix sort - sequenced")
     (Catch::Benchmark::Chronometer meter)
     {
         auto words_to_sort = words;
         REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
 
-        meter.measure([&] {
-            std::for_each(std::execution::par, words_to_sort.begin(), words_to_sort.end(), [](auto &w) { boost::to_lower(w); });
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
+            Algorithms::radix_sort(words_to_sort.begin(), words_to_sort.end(), Algorithms::ascii_lower_bytes);
+            return words_to_sort.front();
+        });
+    };
+
+    BENCHMARK_ADVANCED("radix sort - parallel")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto words_to_sort = words;
+        REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
+
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
+            Algorithms::radix_sort(std::execution::par, words_to_sort.begin(), words_to_sort.end(), Algorithms::ascii_lower_bytes);
+            return words_to_sort.front();
+        });
+    };
+
+    // phases are traced with --trace - spans of single elements show occupancy of worker threads
+    BENCHMARK_ADVANCED("parallel unsequenced")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto words_to_sort = [&] {
+            Benchmarking::ScopedSpan span{"load"};
+            return words;
+        }();
+        REQUIRE_FALSE(std::is_sorted(words_to_sort.begin(), words_to_sort.end()));
+
+        Benchmarking::measure(meter, words_to_sort.size(), [&] {
+            Benchmarking::ScopedSpan run_span{"parallel unsequenced"};
+
+            {
+                Benchmarking::ScopedSpan span{"lowercase"};
+                std::for_each(std::execution::par, words_to_sort.begin(), words_to_sort.end(), [](auto &w) {
+                    Benchmarking::ScopedSpan element_span{"to_lower_ascii", "element"};
+                    Corpus::to_lower_ascii(w);
+                });
+            }
+
             std::vector<std::string_view> words_views(words_to_sort.size());
-            std::transform(std::execution::par, words_to_sort.begin(), words_to_sort.end(), words_views.begin(), [](const auto &w) { return std::string_view(w); });
+            {
+                Benchmarking::ScopedSpan span{"views"};
+                std::transform(std::execution::par, words_to_sort.begin(), words_to_sort.end(), words_views.begin(), [](const auto &w) {
+                    Benchmarking::ScopedSpan element_span{"string_view", "element"};
+                    return std::string_view(w);
+                });
+            }
+
+            {
+                Benchmarking::ScopedSpan span{"sort"};
+                std::sort(
+                    std::execution::par_unseq,
+                    words_views.begin(), words_views.end());
+            }
+
+            return std::string(words_views.front());
+        });
+    };
+
+    BENCHMARK_ADVANCED("TokenColumn - parallel unsequenced")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto column_to_sort = words_column;
+
+        Benchmarking::measure(meter, column_to_sort.size(), [&] {
+            Corpus::to_lower_ascii(column_to_sort);
+            std::vector<std::string_view> words_views = column_to_sort.views();
 
             std::sort(
                 std::execution::par_unseq,
@@ -111,6 +663,118 @@ TEST_CASE("sort")
     };
 }
 
+TEST_CASE("sort - data shapes", "[.][shapes]")
+{
+    const auto &words = Benchmarking::fixture<DocumentContent>("words");
+
+    for (auto shape : Datasets::all_word_shapes)
+    {
+        const auto shaped_words = Datasets::generate_words(shape, words.size());
+
+        BENCHMARK_ADVANCED("std::sort - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto words_to_sort = shaped_words;
+
+            Benchmarking::measure(meter, words_to_sort.size(), [&] {
+                std::sort(words_to_sort.begin(), words_to_sort.end());
+                return words_to_sort.front();
+            });
+        };
+
+        BENCHMARK_ADVANCED("std::sort parallel - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto words_to_sort = shaped_words;
+
+            Benchmarking::measure(meter, words_to_sort.size(), [&] {
+                std::sort(std::execution::par, words_to_sort.begin(), words_to_sort.end());
+                return words_to_sort.front();
+            });
+        };
+
+        BENCHMARK_ADVANCED("radix sort - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto words_to_sort = shaped_words;
+
+            Benchmarking::measure(meter, words_to_sort.size(), [&] {
+                Algorithms::radix_sort(words_to_sort.begin(), words_to_sort.end(), Algorithms::identity_bytes);
+                return words_to_sort.front();
+            });
+        };
+    }
+
+    for (auto shape : Datasets::all_number_shapes)
+    {
+        const auto shaped_numbers = Datasets::generate_numbers(shape, 1'000'000, {1'000'000});
+
+        BENCHMARK_ADVANCED("numbers - std::sort - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto numbers_to_sort = shaped_numbers;
+
+            Benchmarking::measure(meter, numbers_to_sort.size(), [&] {
+                std::sort(numbers_to_sort.begin(), numbers_to_sort.end());
+                return numbers_to_sort.front();
+            });
+        };
+
+        BENCHMARK_ADVANCED("numbers - std::sort parallel unsequenced - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto numbers_to_sort = shaped_numbers;
+
+            Benchmarking::measure(meter, numbers_to_sort.size(), [&] {
+                std::sort(std::execution::par_unseq, numbers_to_sort.begin(), numbers_to_sort.end());
+                return numbers_to_sort.front();
+            });
+        };
+    }
+}
+
+TEST_CASE("case folding")
+{
+    const auto &words = Benchmarking::fixture<DocumentContent>("words");
+    const auto &words_column = Benchmarking::fixture<Corpus::TokenColumn>("words column");
+
+    BENCHMARK_ADVANCED("boost::to_lower")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto words_to_fold = words;
+
+        Benchmarking::measure(meter, words_to_fold.size(), [&] {
+            std::for_each(words_to_fold.begin(), words_to_fold.end(), [](auto &w) { boost::to_lower(w); });
+            return words_to_fold.front();
+        });
+    };
+
+    for (auto [name, kernel] : {std::pair{"scalar", Corpus::CaseFoldingKernel::scalar}, std::pair{"sse2", Corpus::CaseFoldingKernel::sse2}, std::pair{"best", Corpus::CaseFoldingKernel::best}})
+    {
+        BENCHMARK_ADVANCED(std::string("to_lower_ascii - ") + name)
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto words_to_fold = words;
+
+            Benchmarking::measure(meter, words_to_fold.size(), [&] {
+                std::for_each(words_to_fold.begin(), words_to_fold.end(), [=](auto &w) { Corpus::to_lower_ascii(w, kernel); });
+                return words_to_fold.front();
+            });
+        };
+    }
+
+    BENCHMARK_ADVANCED("to_lower_ascii - TokenColumn")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto column_to_fold = words_column;
+
+        Benchmarking::measure(meter, column_to_fold.size(), [&] {
+            Corpus::to_lower_ascii(column_to_fold);
+            return column_to_fold[0];
+        });
+    };
+}
+
 bool is_prime(uint64_t number)
 {
     if (number < 2)
@@ -132,28 +796,52 @@ bool is_prime(uint64_t number)
     }
 }
 
-const size_t no_of_items = 20'000;
+TEST_CASE("is_prime vs. Miller-Rabin - magnitude sweep", "[.][primes]")
+{
+    // trial division needs ~sqrt(n)/2 divisions for every prime - beyond 2^48 a single run takes minutes
+    const int trial_division_max_bits = 48;
+    const size_t no_of_candidates = 64;
+
+    for (int bits : {16, 24, 32, 40, 48, 56, 63})
+    {
+        std::vector<uint64_t> candidates(no_of_candidates);
+        std::iota(candidates.begin(), candidates.end(), uint64_t{0});
+        std::transform(candidates.begin(), candidates.end(), candidates.begin(), [=](uint64_t i) { return (uint64_t{1} << bits) + 2 * i + 1; });
+
+        if (bits <= trial_division_max_bits)
+        {
+            REQUIRE(std::all_of(candidates.begin(), candidates.end(), [](auto n) { return is_prime(n) == Primes::is_prime_miller_rabin(n); }));
 
-const std::vector<uint64_t> numbers = [] {
-    std::random_device rd;
-    std::mt19937_64 rnd_gen{rd()};
-    std::uniform_int_distribution<uint64_t> rnd_distr(0, no_of_items);
+            BENCHMARK("trial division - 2^" + std::to_string(bits))
+            {
+                return std::count_if(candidates.begin(), candidates.end(), [](auto n) { return is_prime(n); });
+            };
+        }
+
+        BENCHMARK("Miller-Rabin - 2^" + std::to_string(bits))
+        {
+            return std::count_if(candidates.begin(), candidates.end(), [](auto n) { return Primes::is_prime_miller_rabin(n); });
+        };
+    }
+}
 
-    std::vector<uint64_t> numbers(no_of_items);
-    std::generate(numbers.begin(), numbers.end(), [&] { return rnd_distr(rnd_gen); });
+const size_t no_of_items = 20'000;
 
-    return numbers;
-}();
+const Benchmarking::RegisterFixture<std::vector<uint64_t>> numbers_fixture{"numbers", [] {
+    return Datasets::generate_numbers(std::execution::par, Datasets::NumberShape::uniform, no_of_items, {no_of_items});
+}};
 
 TEST_CASE("transform")
 {
+    const auto &numbers = Benchmarking::fixture<std::vector<uint64_t>>("numbers");
+
     BENCHMARK_ADVANCED("sequenced")
     (Catch::Benchmark::Chronometer meter)
     {
         auto numbers_to_part = numbers;
         decltype(numbers_to_part) are_primes(numbers_to_part.size());
 
-        meter.measure([&] {
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
             std::transform(numbers_to_part.begin(), numbers_to_part.end(), are_primes.begin(), [](auto n) { return is_prime(n); });
             return are_primes;
         });
@@ -165,21 +853,104 @@ TEST_CASE("transform")
         auto numbers_to_part = numbers;
         decltype(numbers_to_part) are_primes(numbers_to_part.size());
 
-        meter.measure([&] {
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
             std::transform(std::execution::par_unseq, numbers_to_part.begin(), numbers_to_part.end(), are_primes.begin(), [](auto n) { return is_prime(n); });
             return are_primes;
         });
     };
+
+    // seq or par_unseq by the cost model of the machine - see the [calibrate] test case
+    BENCHMARK_ADVANCED("adaptive")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+        decltype(numbers_to_part) are_primes(numbers_to_part.size());
+        const auto policy = Concurrency::adaptive("transform is_prime");
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            Concurrency::transform(policy, numbers_to_part.begin(), numbers_to_part.end(), are_primes.begin(), [](auto n) { return is_prime(n); });
+            return are_primes;
+        });
+    };
+
+    BENCHMARK_ADVANCED("thread pool - parallel_transform")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+        decltype(numbers_to_part) are_primes(numbers_to_part.size());
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            Concurrency::parallel_transform(Concurrency::ThreadPool::shared(), numbers_to_part.begin(), numbers_to_part.end(), are_primes.begin(), [](auto n) { return is_prime(n); });
+            return are_primes;
+        });
+    };
+
+    BENCHMARK_ADVANCED("Miller-Rabin - sequenced")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+        decltype(numbers_to_part) are_primes(numbers_to_part.size());
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            std::transform(numbers_to_part.begin(), numbers_to_part.end(), are_primes.begin(), [](auto n) { return Primes::is_prime_miller_rabin(n); });
+            return are_primes;
+        });
+    };
+
+    BENCHMARK_ADVANCED("prime table - sequenced")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+        decltype(numbers_to_part) are_primes(numbers_to_part.size());
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            std::transform(numbers_to_part.begin(), numbers_to_part.end(), are_primes.begin(), [](auto n) { return Primes::is_prime(n); });
+            return are_primes;
+        });
+    };
+
+    BENCHMARK_ADVANCED("prime table - parallel")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+        decltype(numbers_to_part) are_primes(numbers_to_part.size());
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            std::transform(std::execution::par_unseq, numbers_to_part.begin(), numbers_to_part.end(), are_primes.begin(), [](auto n) { return Primes::is_prime(n); });
+            return are_primes;
+        });
+    };
+
+    const Primes::SegmentedSieve sieve;
+
+    {
+        std::vector<uint64_t> expected(numbers.size());
+        std::transform(numbers.begin(), numbers.end(), expected.begin(), [](auto n) { return is_prime(n); });
+        const auto are_primes = sieve.are_primes(numbers);
+        REQUIRE(std::equal(are_primes.begin(), are_primes.end(), expected.begin(), expected.end()));
+    }
+
+    BENCHMARK("segmented sieve - sequenced")
+    {
+        return sieve.are_primes(numbers);
+    };
+
+    BENCHMARK("segmented sieve - parallel")
+    {
+        return sieve.are_primes(std::execution::par, numbers);
+    };
 }
 
 TEST_CASE("partition")
 {
+    const auto &numbers = Benchmarking::fixture<std::vector<uint64_t>>("numbers");
+
     BENCHMARK_ADVANCED("sequenced")
     (Catch::Benchmark::Chronometer meter)
     {
         auto numbers_to_part = numbers;
 
-        meter.measure([&] {
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
             return std::partition(numbers_to_part.begin(), numbers_to_part.end(), [](auto n) { return is_prime(n); });
         });
     };
@@ -189,8 +960,263 @@ TEST_CASE("partition")
     {
         auto numbers_to_part = numbers;
 
-        meter.measure([&] {
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
             return std::partition(std::execution::par_unseq, numbers_to_part.begin(), numbers_to_part.end(), [](auto n) { return is_prime(n); });
         });
     };
-}
\ No newline at end of file
+
+    BENCHMARK_ADVANCED("thread pool - parallel_partition")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            return Concurrency::parallel_partition(Concurrency::ThreadPool::shared(), numbers_to_part.begin(), numbers_to_part.end(), [](auto n) { return is_prime(n); });
+        });
+    };
+
+    BENCHMARK_ADVANCED("prime table - sequenced")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            return std::partition(numbers_to_part.begin(), numbers_to_part.end(), [](auto n) { return Primes::is_prime(n); });
+        });
+    };
+
+    BENCHMARK_ADVANCED("segmented sieve - sequenced")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+        const Primes::SegmentedSieve sieve;
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            return sieve.partition(numbers_to_part.begin(), numbers_to_part.end());
+        });
+    };
+
+    BENCHMARK_ADVANCED("segmented sieve - parallel")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto numbers_to_part = numbers;
+        const Primes::SegmentedSieve sieve;
+
+        Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+            return sieve.partition(std::execution::par, numbers_to_part.begin(), numbers_to_part.end());
+        });
+    };
+}
+
+TEST_CASE("partition - data shapes", "[.][shapes]")
+{
+    for (auto shape : Datasets::all_number_shapes)
+    {
+        const auto shaped_numbers = Datasets::generate_numbers(shape, no_of_items, {no_of_items});
+
+        BENCHMARK_ADVANCED("trial division - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto numbers_to_part = shaped_numbers;
+
+            Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+                return std::partition(numbers_to_part.begin(), numbers_to_part.end(), [](auto n) { return is_prime(n); });
+            });
+        };
+
+        BENCHMARK_ADVANCED("prime table - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto numbers_to_part = shaped_numbers;
+
+            Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+                return std::partition(numbers_to_part.begin(), numbers_to_part.end(), [](auto n) { return Primes::is_prime(n); });
+            });
+        };
+
+        BENCHMARK_ADVANCED("segmented sieve - parallel - " + Datasets::to_string(shape))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto numbers_to_part = shaped_numbers;
+            const Primes::SegmentedSieve sieve;
+
+            Benchmarking::measure(meter, numbers_to_part.size(), [&] {
+                return sieve.partition(std::execution::par, numbers_to_part.begin(), numbers_to_part.end());
+            });
+        };
+    }
+}
+
+TEST_CASE("dataset generation", "[.][datasets]")
+{
+    const size_t size = 10'000'000;
+
+    BENCHMARK_ADVANCED("std::generate - mt19937_64")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<uint64_t> data(size);
+
+        Benchmarking::measure(meter, data.size(), [&] {
+            std::mt19937_64 rnd_gen{Datasets::default_seed};
+            std::uniform_int_distribution<uint64_t> distr(0, no_of_items);
+            std::generate(data.begin(), data.end(), [&] { return distr(rnd_gen); });
+            return data.back();
+        });
+    };
+
+    BENCHMARK_ADVANCED("parallel_generate - Philox - sequenced")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<uint64_t> data(size);
+
+        Benchmarking::measure(meter, data.size(), [&] {
+            Datasets::parallel_generate(std::execution::seq, data.begin(), data.end(), Datasets::default_seed,
+                [](Datasets::CounterEngine& engine) { return Datasets::uniform_between(engine, 0, no_of_items); });
+            return data.back();
+        });
+    };
+
+    BENCHMARK_ADVANCED("parallel_generate - Philox - parallel")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<uint64_t> data(size);
+
+        Benchmarking::measure(meter, data.size(), [&] {
+            Datasets::parallel_generate(std::execution::par, data.begin(), data.end(), Datasets::default_seed,
+                [](Datasets::CounterEngine& engine) { return Datasets::uniform_between(engine, 0, no_of_items); });
+            return data.back();
+        });
+    };
+
+    for (auto shape : {Datasets::NumberShape::uniform, Datasets::NumberShape::zipf, Datasets::NumberShape::sorted})
+    {
+        BENCHMARK("generate_numbers - parallel - " + Datasets::to_string(shape))
+        {
+            return Datasets::generate_numbers(std::execution::par, shape, size, {no_of_items});
+        };
+    }
+}
+
+///////////////////////////////////////////////////////////////
+// calibration of the adaptive policy - cost models are saved to the --adaptive-profile file
+
+TEST_CASE("calibrate adaptive policy", "[.][calibrate]")
+{
+    auto &adaptive = Concurrency::adaptive_policy();
+
+    auto make_numbers = [](size_t size) { return Datasets::generate_numbers(std::execution::par, Datasets::NumberShape::uniform, size, {no_of_items}); };
+
+    adaptive.calibrate(
+        "transform is_prime", [&](size_t size) { return std::pair{make_numbers(size), std::vector<uint64_t>(size)}; },
+        [](auto &&policy, auto &data) { std::transform(policy, data.first.begin(), data.first.end(), data.second.begin(), [](auto n) { return is_prime(n); }); });
+
+    adaptive.calibrate("sort numbers", make_numbers, [](auto &&policy, auto &data) { std::sort(policy, data.begin(), data.end()); });
+
+    adaptive.calibrate(
+        "reduce numbers", make_numbers, [](auto &&policy, auto &data) { return std::reduce(policy, data.begin(), data.end(), uint64_t{0}); });
+
+    for (const auto &workload : {"transform is_prime", "sort numbers", "reduce numbers"})
+    {
+        std::cout << workload << ":";
+        for (size_t size : {size_t{1} << 10, size_t{1} << 14, size_t{1} << 18, size_t{1} << 22})
+            std::cout << " " << size << " - " << Concurrency::to_string(adaptive.choose(workload, size)) << ";";
+        std::cout << "\n";
+    }
+
+    adaptive.save_profile();
+    std::cout << "Profile saved to " << adaptive.profile_file_name() << std::endl;
+}
+
+///////////////////////////////////////////////////////////////
+// scaling sweep - run with "[sweep]" (see --sweep-* options)
+
+namespace
+{
+    std::vector<uint64_t> random_numbers(size_t size)
+    {
+        std::mt19937_64 rnd_gen{size};
+        std::uniform_int_distribution<uint64_t> rnd_distr(0, size);
+
+        std::vector<uint64_t> numbers(size);
+        std::generate(numbers.begin(), numbers.end(), [&] { return rnd_distr(rnd_gen); });
+
+        return numbers;
+    }
+
+    std::vector<std::string_view> random_words(size_t size)
+    {
+        const auto &words_column = Benchmarking::fixture<Corpus::TokenColumn>("words column");
+        std::mt19937_64 rnd_gen{size};
+        std::uniform_int_distribution<size_t> rnd_distr(0, words_column.size() - 1);
+
+        std::vector<std::string_view> sample(size);
+        std::generate(sample.begin(), sample.end(), [&] { return words_column[rnd_distr(rnd_gen)]; });
+
+        return sample;
+    }
+
+    struct NumbersWithFlags
+    {
+        std::vector<uint64_t> numbers;
+        std::vector<uint8_t> are_primes;
+    };
+
+    NumbersWithFlags random_numbers_with_flags(size_t size)
+    {
+        return {random_numbers(size), std::vector<uint8_t>(size)};
+    }
+}
+
+TEST_CASE("scaling sweep", "[.][sweep]")
+{
+    const auto &config = Benchmarking::sweep_config();
+
+    std::vector<Benchmarking::SweepResult> results;
+
+    results.push_back(Benchmarking::run_sweep(
+        "sort words - std::execution::par", config, random_words,
+        [](auto &data) { std::sort(data.begin(), data.end()); },
+        [](auto &data, auto &) { std::sort(std::execution::par, data.begin(), data.end()); }));
+
+    results.push_back(Benchmarking::run_sweep(
+        "sort words - thread pool", config, random_words,
+        [](auto &data) { std::sort(data.begin(), data.end()); },
+        [](auto &data, auto &pool) { Concurrency::parallel_sort(pool, data.begin(), data.end()); }));
+
+    results.push_back(Benchmarking::run_sweep(
+        "sort numbers - std::execution::par_unseq", config, random_numbers,
+        [](auto &data) { std::sort(data.begin(), data.end()); },
+        [](auto &data, auto &) { std::sort(std::execution::par_unseq, data.begin(), data.end()); }));
+
+    results.push_back(Benchmarking::run_sweep(
+        "transform is_prime - std::execution::par_unseq", config, random_numbers_with_flags,
+        [](auto &data) { std::transform(data.numbers.begin(), data.numbers.end(), data.are_primes.begin(), [](auto n) { return Primes::is_prime(n); }); },
+        [](auto &data, auto &) {
+            std::transform(std::execution::par_unseq, data.numbers.begin(), data.numbers.end(), data.are_primes.begin(), [](auto n) { return Primes::is_prime(n); });
+        }));
+
+    results.push_back(Benchmarking::run_sweep(
+        "transform is_prime - thread pool", config, random_numbers_with_flags,
+        [](auto &data) { std::transform(data.numbers.begin(), data.numbers.end(), data.are_primes.begin(), [](auto n) { return Primes::is_prime(n); }); },
+        [](auto &data, auto &pool) {
+            Concurrency::parallel_transform(pool, data.numbers.begin(), data.numbers.end(), data.are_primes.begin(), [](auto n) { return Primes::is_prime(n); });
+        }));
+
+    results.push_back(Benchmarking::run_sweep(
+        "partition is_prime - std::execution::par_unseq", config, random_numbers,
+        [](auto &data) { std::partition(data.begin(), data.end(), [](auto n) { return Primes::is_prime(n); }); },
+        [](auto &data, auto &) { std::partition(std::execution::par_unseq, data.begin(), data.end(), [](auto n) { return Primes::is_prime(n); }); }));
+
+    results.push_back(Benchmarking::run_sweep(
+        "reduce - std::execution::par_unseq", config, random_numbers,
+        [](auto &data) { data.front() = std::reduce(data.begin(), data.end()); },
+        [](auto &data, auto &) { data.front() = std::reduce(std::execution::par_unseq, data.begin(), data.end()); }));
+
+    for (const auto &result : results)
+        Benchmarking::print_sweep(std::cout, result);
+
+    if (!config.csv_file_name.empty())
+    {
+        std::ofstream csv_file{config.csv_file_name};
+        Benchmarking::write_sweep_csv_header(csv_file);
+        for (const auto &result : results)
+            Benchmarking::write_sweep_csv(csv_file, result);
+    }
+}
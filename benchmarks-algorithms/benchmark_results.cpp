@@ -0,0 +1,533 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "benchmark_results.hpp"
+
+#include <algorithm>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Benchmarking
+{
+    BenchmarkResults& recorded_results()
+    {
+        static BenchmarkResults results;
+        return results;
+    }
+
+    class ResultsListener : public Catch::TestEventListenerBase
+    {
+        std::string test_case_;
+
+    public:
+        using TestEventListenerBase::TestEventListenerBase;
+
+        void testCaseStarting(const Catch::TestCaseInfo& test_info) override
+        {
+            TestEventListenerBase::testCaseStarting(test_info);
+            test_case_ = test_info.name;
+        }
+
+        void benchmarkStarting(const Catch::BenchmarkInfo& info) override
+        {
+            TestEventListenerBase::benchmarkStarting(info);
+
+            if (perf_recorder().is_enabled)
+                perf_recorder().current = PerfSample{};
+
+            if (allocation_recorder().is_enabled)
+                allocation_recorder().current = AllocationSample{};
+
+            if (histogram_recorder().is_enabled)
+                histogram_recorder().current.emplace(histogram_recorder().significant_digits);
+        }
+
+        void benchmarkEnded(const Catch::BenchmarkStats<>& stats) override
+        {
+            BenchmarkResult result;
+            result.test_case = test_case_;
+            result.name = stats.info.name;
+            result.iterations = stats.info.iterations;
+
+            result.samples.reserve(stats.samples.size());
+            for (const auto& sample : stats.samples)
+                result.samples.push_back(sample.count());
+
+            result.mean = {stats.mean.point.count(), stats.mean.lower_bound.count(), stats.mean.upper_bound.count()};
+            result.standard_deviation = {stats.standardDeviation.point.count(), stats.standardDeviation.lower_bound.count(),
+                stats.standardDeviation.upper_bound.count()};
+            result.outliers = {stats.outliers.samples_seen, stats.outliers.low_severe, stats.outliers.low_mild, stats.outliers.high_mild,
+                stats.outliers.high_severe};
+            result.outlier_variance = stats.outlierVariance;
+
+            if (auto& counters = perf_recorder().current; counters && counters->runs > 0 && !counters->counts.empty())
+                result.counters = std::move(counters);
+            perf_recorder().current.reset();
+
+            if (auto& allocations = allocation_recorder().current; allocations && allocations->runs > 0)
+                result.allocations = std::move(allocations);
+            allocation_recorder().current.reset();
+
+            if (auto& latencies = histogram_recorder().current; latencies && latencies->total_count() > 0)
+                result.latencies = std::move(latencies);
+            histogram_recorder().current.reset();
+
+            recorded_results().push_back(std::move(result));
+        }
+    };
+
+    CATCH_REGISTER_LISTENER(ResultsListener)
+
+    namespace
+    {
+        std::string json_escaped(const std::string& text)
+        {
+            std::ostringstream out;
+
+            for (char c : text)
+            {
+                switch (c)
+                {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                case '\t':
+                    out << "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                    else
+                        out << c;
+                }
+            }
+
+            return out.str();
+        }
+
+        std::string csv_escaped(const std::string& text)
+        {
+            std::string quoted = "\"";
+
+            for (char c : text)
+            {
+                if (c == '"')
+                    quoted += '"';
+                quoted += c;
+            }
+
+            return quoted + "\"";
+        }
+
+        // JSON has no representation for nan and inf
+        double json_number(double value)
+        {
+            return std::isfinite(value) ? value : 0.0;
+        }
+
+        void write_json(std::ostream& out, const Estimate& estimate)
+        {
+            out << "{\"point\": " << json_number(estimate.point) << ", \"lower_bound\": " << json_number(estimate.lower_bound)
+                << ", \"upper_bound\": " << json_number(estimate.upper_bound) << "}";
+        }
+
+        void write_json(std::ostream& out, const PerfSample& counters)
+        {
+            out << "{\"runs\": " << counters.runs << ", \"no_of_elements\": " << counters.no_of_elements;
+
+            for (size_t i = 0; i < no_of_perf_events; ++i)
+                if (counters.counts.values[i])
+                    out << ", \"" << perf_event_names[i] << "\": " << json_number(*counters.counts.values[i]);
+
+            out << "}";
+        }
+
+        PerfSample read_counters(const boost::property_tree::ptree& tree)
+        {
+            PerfSample counters;
+            counters.runs = tree.get<uint64_t>("runs");
+            counters.no_of_elements = tree.get<size_t>("no_of_elements");
+
+            for (size_t i = 0; i < no_of_perf_events; ++i)
+                if (auto value = tree.get_optional<double>(perf_event_names[i]))
+                    counters.counts.values[i] = *value;
+
+            return counters;
+        }
+
+        void write_json(std::ostream& out, const AllocationSample& allocations)
+        {
+            out << "{\"runs\": " << allocations.runs << ", \"allocations\": " << allocations.counts.allocations
+                << ", \"deallocations\": " << allocations.counts.deallocations << ", \"bytes_allocated\": " << allocations.counts.bytes_allocated
+                << ", \"peak_live_bytes\": " << allocations.peak_live_bytes << "}";
+        }
+
+        AllocationSample read_allocations(const boost::property_tree::ptree& tree)
+        {
+            AllocationSample allocations;
+            allocations.runs = tree.get<uint64_t>("runs");
+            allocations.counts.allocations = tree.get<uint64_t>("allocations");
+            allocations.counts.deallocations = tree.get<uint64_t>("deallocations");
+            allocations.counts.bytes_allocated = tree.get<uint64_t>("bytes_allocated");
+            allocations.peak_live_bytes = tree.get<int64_t>("peak_live_bytes");
+            return allocations;
+        }
+
+        std::string percentile_label(double percentile)
+        {
+            std::ostringstream label;
+            label << "p" << percentile;
+            return label.str();
+        }
+
+        // no dots - they separate paths in property_tree
+        std::string percentile_key(double percentile)
+        {
+            auto key = percentile_label(percentile);
+            std::replace(key.begin(), key.end(), '.', '_');
+            return key;
+        }
+
+        void write_json(std::ostream& out, const LatencyHistogram& latencies)
+        {
+            out << "{\"count\": " << latencies.total_count() << ", \"min\": " << latencies.min();
+
+            for (double percentile : reported_percentiles)
+                out << ", \"" << percentile_key(percentile) << "\": " << latencies.value_at_percentile(percentile);
+
+            out << ", \"max\": " << latencies.max() << ", \"histogram\": \"" << latencies.dump() << "\"}";
+        }
+
+        void write_csv_field(std::ostream& out, const std::optional<double>& value)
+        {
+            out << ",";
+            if (value)
+                out << *value;
+        }
+
+        Estimate read_estimate(const boost::property_tree::ptree& tree)
+        {
+            return {tree.get<double>("point"), tree.get<double>("lower_bound"), tree.get<double>("upper_bound")};
+        }
+
+        double normal_cdf_complement(double z)
+        {
+            return 0.5 * std::erfc(z / std::sqrt(2.0));
+        }
+    }
+
+    void write_json(std::ostream& out, const BenchmarkResults& results)
+    {
+        const auto precision = out.precision(17);
+
+        out << "{\n  \"benchmarks\": [";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+
+            out << (i == 0 ? "\n" : ",\n") << "    {\n"
+                << "      \"test_case\": \"" << json_escaped(result.test_case) << "\",\n"
+                << "      \"name\": \"" << json_escaped(result.name) << "\",\n"
+                << "      \"iterations\": " << result.iterations << ",\n"
+                << "      \"mean_ns\": ";
+            write_json(out, result.mean);
+            out << ",\n      \"std_dev_ns\": ";
+            write_json(out, result.standard_deviation);
+            out << ",\n      \"outliers\": {\"samples_seen\": " << result.outliers.samples_seen
+                << ", \"low_severe\": " << result.outliers.low_severe << ", \"low_mild\": " << result.outliers.low_mild
+                << ", \"high_mild\": " << result.outliers.high_mild << ", \"high_severe\": " << result.outliers.high_severe << "},\n"
+                << "      \"outlier_variance\": " << json_number(result.outlier_variance) << ",\n";
+
+            if (result.counters)
+            {
+                out << "      \"counters\": ";
+                write_json(out, *result.counters);
+                out << ",\n";
+            }
+
+            if (result.allocations)
+            {
+                out << "      \"allocations\": ";
+                write_json(out, *result.allocations);
+                out << ",\n";
+            }
+
+            if (result.latencies)
+            {
+                out << "      \"latencies_ns\": ";
+                write_json(out, *result.latencies);
+                out << ",\n";
+            }
+
+            out << "      \"samples_ns\": [";
+
+            for (size_t s = 0; s < result.samples.size(); ++s)
+                out << (s == 0 ? "" : ", ") << json_number(result.samples[s]);
+
+            out << "]\n    }";
+        }
+
+        out << "\n  ]\n}\n";
+        out.precision(precision);
+    }
+
+    void write_csv(std::ostream& out, const BenchmarkResults& results)
+    {
+        const auto precision = out.precision(17);
+
+        out << "test_case,name,iterations,mean_ns,mean_lower_ns,mean_upper_ns,std_dev_ns,std_dev_lower_ns,std_dev_upper_ns,"
+               "outliers_seen,low_severe,low_mild,high_mild,high_severe,outlier_variance,"
+               "cycles_per_run,instructions_per_run,ipc,cache_misses_per_element,branch_misses_per_element,llc_loads_per_element,"
+               "allocations_per_run,bytes_allocated_per_run,peak_live_bytes,"
+               "p50_ns,p90_ns,p99_ns,p99.9_ns,max_ns,samples_ns\n";
+
+        for (const auto& result : results)
+        {
+            out << csv_escaped(result.test_case) << "," << csv_escaped(result.name) << "," << result.iterations << ","
+                << result.mean.point << "," << result.mean.lower_bound << "," << result.mean.upper_bound << ","
+                << result.standard_deviation.point << "," << result.standard_deviation.lower_bound << "," << result.standard_deviation.upper_bound << ","
+                << result.outliers.samples_seen << "," << result.outliers.low_severe << "," << result.outliers.low_mild << ","
+                << result.outliers.high_mild << "," << result.outliers.high_severe << "," << result.outlier_variance;
+
+            const auto counters = result.counters.value_or(PerfSample{});
+            write_csv_field(out, counters.per_run(PerfEvent::cycles));
+            write_csv_field(out, counters.per_run(PerfEvent::instructions));
+            write_csv_field(out, counters.instructions_per_cycle());
+            write_csv_field(out, counters.per_element(PerfEvent::cache_misses));
+            write_csv_field(out, counters.per_element(PerfEvent::branch_misses));
+            write_csv_field(out, counters.per_element(PerfEvent::llc_loads));
+
+            if (result.allocations)
+                out << "," << result.allocations->allocations_per_run() << "," << result.allocations->bytes_per_run() << ","
+                    << result.allocations->peak_live_bytes;
+            else
+                out << ",,,";
+
+            for (double percentile : reported_percentiles)
+                write_csv_field(out, result.latencies ? std::optional<double>(result.latencies->value_at_percentile(percentile)) : std::nullopt);
+            write_csv_field(out, result.latencies ? std::optional<double>(result.latencies->max()) : std::nullopt);
+
+            out << ",\"";
+
+            for (size_t s = 0; s < result.samples.size(); ++s)
+                out << (s == 0 ? "" : " ") << result.samples[s];
+
+            out << "\"\n";
+        }
+
+        out.precision(precision);
+    }
+
+    void print_counters(std::ostream& out, const BenchmarkResults& results)
+    {
+        auto print = [&out](const std::optional<double>& value, int width, int precision) {
+            if (value)
+                out << std::fixed << std::setprecision(precision) << std::setw(width) << *value << std::defaultfloat;
+            else
+                out << std::setw(width) << "-";
+        };
+
+        out << "\nHardware counters:\n"
+            << std::left << std::setw(60) << "benchmark" << std::right << std::setw(14) << "mean [ns]" << std::setw(8) << "IPC"
+            << std::setw(16) << "cache-miss/el" << std::setw(16) << "branch-miss/el" << std::setw(16) << "LLC-load/el" << "\n";
+
+        for (const auto& result : results)
+        {
+            if (!result.counters)
+                continue;
+
+            out << std::left << std::setw(60) << result.id() << std::right;
+            print(result.mean.point, 14, 0);
+            print(result.counters->instructions_per_cycle(), 8, 2);
+            print(result.counters->per_element(PerfEvent::cache_misses), 16, 4);
+            print(result.counters->per_element(PerfEvent::branch_misses), 16, 4);
+            print(result.counters->per_element(PerfEvent::llc_loads), 16, 4);
+            out << "\n";
+        }
+    }
+
+    void print_allocations(std::ostream& out, const BenchmarkResults& results)
+    {
+        out << "\nAllocations per iteration:\n"
+            << std::left << std::setw(60) << "benchmark" << std::right << std::setw(14) << "mean [ns]" << std::setw(14) << "allocations"
+            << std::setw(16) << "bytes" << std::setw(16) << "peak live bytes" << "\n";
+
+        for (const auto& result : results)
+        {
+            if (!result.allocations)
+                continue;
+
+            out << std::left << std::setw(60) << result.id() << std::right << std::fixed << std::setprecision(0)
+                << std::setw(14) << result.mean.point << std::setprecision(1) << std::setw(14) << result.allocations->allocations_per_run()
+                << std::setw(16) << result.allocations->bytes_per_run() << std::defaultfloat << std::setw(16) << result.allocations->peak_live_bytes << "\n";
+        }
+    }
+
+    void print_latencies(std::ostream& out, const BenchmarkResults& results)
+    {
+        out << "\nLatencies of single iterations [ns]:\n" << std::left << std::setw(60) << "benchmark" << std::right << std::setw(14) << "mean";
+        for (double percentile : reported_percentiles)
+            out << std::setw(14) << percentile_label(percentile);
+        out << std::setw(14) << "max" << "\n";
+
+        for (const auto& result : results)
+        {
+            if (!result.latencies)
+                continue;
+
+            out << std::left << std::setw(60) << result.id() << std::right << std::fixed << std::setprecision(0) << std::setw(14) << result.mean.point
+                << std::defaultfloat;
+            for (double percentile : reported_percentiles)
+                out << std::setw(14) << result.latencies->value_at_percentile(percentile);
+            out << std::setw(14) << result.latencies->max() << "\n";
+        }
+    }
+
+    BenchmarkResults read_json(std::istream& in)
+    {
+        BenchmarkResults results;
+
+        try
+        {
+            boost::property_tree::ptree tree;
+            boost::property_tree::read_json(in, tree);
+
+            for (const auto& [key, item] : tree.get_child("benchmarks"))
+            {
+                BenchmarkResult result;
+                result.test_case = item.get<std::string>("test_case");
+                result.name = item.get<std::string>("name");
+                result.iterations = item.get<int>("iterations");
+                result.mean = read_estimate(item.get_child("mean_ns"));
+                result.standard_deviation = read_estimate(item.get_child("std_dev_ns"));
+
+                const auto& outliers = item.get_child("outliers");
+                result.outliers = {outliers.get<int>("samples_seen"), outliers.get<int>("low_severe"), outliers.get<int>("low_mild"),
+                    outliers.get<int>("high_mild"), outliers.get<int>("high_severe")};
+                result.outlier_variance = item.get<double>("outlier_variance");
+
+                if (auto counters = item.get_child_optional("counters"))
+                    result.counters = read_counters(*counters);
+
+                if (auto allocations = item.get_child_optional("allocations"))
+                    result.allocations = read_allocations(*allocations);
+
+                if (auto latencies = item.get_child_optional("latencies_ns"))
+                    result.latencies = LatencyHistogram::parse(latencies->get<std::string>("histogram"));
+
+                for (const auto& [sample_key, sample] : item.get_child("samples_ns"))
+                    result.samples.push_back(sample.get_value<double>());
+
+                results.push_back(std::move(result));
+            }
+        }
+        catch (const boost::property_tree::ptree_error& e)
+        {
+            throw std::runtime_error(std::string("malformed benchmark results: ") + e.what());
+        }
+        catch (const std::invalid_argument& e)
+        {
+            throw std::runtime_error(std::string("malformed benchmark results: ") + e.what());
+        }
+
+        return results;
+    }
+
+    MannWhitneyResult mann_whitney_u(const std::vector<double>& first, const std::vector<double>& second)
+    {
+        const double n1 = static_cast<double>(first.size());
+        const double n2 = static_cast<double>(second.size());
+
+        if (first.empty() || second.empty())
+            return {0.0, 0.0, 1.0};
+
+        std::vector<std::pair<double, bool>> values; // value, is from second sample
+        values.reserve(first.size() + second.size());
+        for (double value : first)
+            values.emplace_back(value, false);
+        for (double value : second)
+            values.emplace_back(value, true);
+
+        std::sort(values.begin(), values.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        // average ranks for ties
+        double rank_sum_second = 0.0;
+        double tie_correction = 0.0;
+        for (size_t i = 0; i < values.size();)
+        {
+            size_t j = i + 1;
+            while (j < values.size() && values[j].first == values[i].first)
+                ++j;
+
+            const double average_rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+            for (size_t k = i; k < j; ++k)
+                if (values[k].second)
+                    rank_sum_second += average_rank;
+
+            const double t = static_cast<double>(j - i);
+            tie_correction += t * t * t - t;
+            i = j;
+        }
+
+        const double n = n1 + n2;
+        const double u = rank_sum_second - n2 * (n2 + 1) / 2.0;
+        const double mean_u = n1 * n2 / 2.0;
+        const double variance_u = n1 * n2 / 12.0 * ((n + 1) - tie_correction / (n * (n - 1)));
+
+        if (variance_u <= 0.0)
+            return {u, 0.0, u > mean_u ? 0.0 : 1.0};
+
+        const double z = (u - mean_u - 0.5) / std::sqrt(variance_u);
+
+        return {u, z, normal_cdf_complement(z)};
+    }
+
+    std::vector<Comparison> compare_with_baseline(const BenchmarkResults& baseline, const BenchmarkResults& current, double threshold, double alpha)
+    {
+        std::vector<Comparison> comparisons;
+
+        for (const auto& result : current)
+        {
+            const auto baseline_result = std::find_if(baseline.begin(), baseline.end(), [&](const auto& b) { return b.id() == result.id(); });
+
+            if (baseline_result == baseline.end())
+                continue;
+
+            Comparison comparison{result.id(), baseline_result->mean.point, result.mean.point, 0.0, 1.0, false};
+
+            if (comparison.baseline_mean > 0.0)
+                comparison.change = comparison.current_mean / comparison.baseline_mean - 1.0;
+
+            comparison.p_value = mann_whitney_u(baseline_result->samples, result.samples).p_value;
+            comparison.is_regression = comparison.change > threshold && comparison.p_value < alpha;
+
+            comparisons.push_back(std::move(comparison));
+        }
+
+        return comparisons;
+    }
+
+    void print_comparisons(std::ostream& out, const std::vector<Comparison>& comparisons)
+    {
+        out << "\nComparison with baseline:\n";
+
+        for (const auto& comparison : comparisons)
+        {
+            out << (comparison.is_regression ? "  REGRESSION  " : "  ok          ") << std::left << std::setw(60) << comparison.id << std::right
+                << std::fixed << std::setprecision(1) << std::showpos << std::setw(8) << comparison.change * 100.0 << "%" << std::noshowpos
+                << "  p = " << std::setprecision(4) << comparison.p_value << std::defaultfloat << "\n";
+        }
+    }
+}
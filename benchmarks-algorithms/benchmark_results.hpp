@@ -0,0 +1,102 @@
+#ifndef BENCHMARK_RESULTS_HPP
+#define BENCHMARK_RESULTS_HPP
+
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+
+namespace Benchmarking
+{
+    ///////////////////////////////////////////////////////////////
+    // machine-readable results of Catch benchmarks - all durations in nanoseconds
+
+    struct Estimate
+    {
+        double point = 0.0;
+        double lower_bound = 0.0;
+        double upper_bound = 0.0;
+    };
+
+    struct OutlierCounts
+    {
+        int samples_seen = 0;
+        int low_severe = 0;
+        int low_mild = 0;
+        int high_mild = 0;
+        int high_severe = 0;
+    };
+
+    struct BenchmarkResult
+    {
+        std::string test_case;
+        std::string name;
+        int iterations = 0;
+        std::vector<double> samples;
+        Estimate mean;
+        Estimate standard_deviation;
+        OutlierCounts outliers;
+        double outlier_variance = 0.0;
+        std::optional<PerfSample> counters;          // only with --perf-counters for benchmarks using Benchmarking::measure
+        std::optional<AllocationSample> allocations; // only with --allocations for benchmarks using Benchmarking::measure
+        std::optional<LatencyHistogram> latencies;   // only with --latency-histograms for benchmarks using Benchmarking::measure
+
+        std::string id() const
+        {
+            return test_case + "/" + name;
+        }
+    };
+
+    using BenchmarkResults = std::vector<BenchmarkResult>;
+
+    // results of every benchmark run in this process - filled by a Catch listener
+    BenchmarkResults& recorded_results();
+
+    void write_json(std::ostream& out, const BenchmarkResults& results);
+    void write_csv(std::ostream& out, const BenchmarkResults& results);
+
+    // IPC and events per element next to the mean wall time of benchmarks with hardware counters
+    void print_counters(std::ostream& out, const BenchmarkResults& results);
+
+    // allocations, bytes allocated and peak live bytes per iteration next to the mean wall time
+    void print_allocations(std::ostream& out, const BenchmarkResults& results);
+
+    // percentiles of single iterations next to the mean wall time
+    void print_latencies(std::ostream& out, const BenchmarkResults& results);
+
+    // reads files written by write_json; throws std::runtime_error for malformed input
+    BenchmarkResults read_json(std::istream& in);
+
+    ///////////////////////////////////////////////////////////////
+    // regression check against a stored baseline
+
+    struct MannWhitneyResult
+    {
+        double u;       // U statistic of the second sample
+        double z;       // normal approximation with tie and continuity correction
+        double p_value; // one-sided: values in the second sample tend to be greater
+    };
+
+    MannWhitneyResult mann_whitney_u(const std::vector<double>& first, const std::vector<double>& second);
+
+    struct Comparison
+    {
+        std::string id;
+        double baseline_mean;
+        double current_mean;
+        double change; // current / baseline - 1
+        double p_value;
+        bool is_regression;
+    };
+
+    // a benchmark regressed when it is slower by more than threshold (0.05 - 5%) and the slowdown is significant at alpha
+    std::vector<Comparison> compare_with_baseline(const BenchmarkResults& baseline, const BenchmarkResults& current, double threshold, double alpha);
+
+    void print_comparisons(std::ostream& out, const std::vector<Comparison>& comparisons);
+}
+
+#endif
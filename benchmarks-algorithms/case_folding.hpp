@@ -0,0 +1,150 @@
+#ifndef CASE_FOLDING_HPP
+#define CASE_FOLDING_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "token_column.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CASE_FOLDING_HAS_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CASE_FOLDING_HAS_AVX2 1
+#elif defined(CASE_FOLDING_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define CASE_FOLDING_HAS_AVX2 1
+#define CASE_FOLDING_AVX2_DISPATCH 1 // AVX2 kernel compiled for the target and selected at runtime
+#endif
+
+namespace Corpus
+{
+    ///////////////////////////////////////////////////////////////
+    // locale-free ASCII case folding - only 'A'..'Z' are changed, every other byte is copied as is
+
+    namespace Details
+    {
+        constexpr char to_lower_ascii(char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+        }
+
+        inline void to_lower_ascii_scalar(const char* src, char* dest, size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
+                dest[i] = to_lower_ascii(src[i]);
+        }
+
+#ifdef CASE_FOLDING_HAS_SSE2
+        // 'A'..'Z' is moved to the bottom of the signed range so that a single signed compare detects it
+        inline size_t to_lower_ascii_sse2(const char* src, char* dest, size_t size)
+        {
+            const __m128i shift = _mm_set1_epi8(static_cast<char>(-128 - 'A'));
+            const __m128i upper_bound = _mm_set1_epi8(static_cast<char>(-128 + 26));
+            const __m128i case_bit = _mm_set1_epi8(0x20);
+
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const __m128i is_upper = _mm_cmplt_epi8(_mm_add_epi8(chars, shift), upper_bound);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_or_si128(chars, _mm_and_si128(is_upper, case_bit)));
+            }
+
+            return i;
+        }
+#endif
+
+#ifdef CASE_FOLDING_HAS_AVX2
+#ifdef CASE_FOLDING_AVX2_DISPATCH
+        __attribute__((target("avx2")))
+#endif
+        inline size_t to_lower_ascii_avx2(const char* src, char* dest, size_t size)
+        {
+            const __m256i shift = _mm256_set1_epi8(static_cast<char>(-128 - 'A'));
+            const __m256i upper_bound = _mm256_set1_epi8(static_cast<char>(-128 + 26));
+            const __m256i case_bit = _mm256_set1_epi8(0x20);
+
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                const __m256i is_upper = _mm256_cmpgt_epi8(upper_bound, _mm256_add_epi8(chars, shift));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_or_si256(chars, _mm256_and_si256(is_upper, case_bit)));
+            }
+
+            return i;
+        }
+#endif
+
+        inline bool has_avx2()
+        {
+#if defined(CASE_FOLDING_AVX2_DISPATCH)
+            static const bool is_supported = __builtin_cpu_supports("avx2");
+            return is_supported;
+#elif defined(CASE_FOLDING_HAS_AVX2)
+            return true;
+#else
+            return false;
+#endif
+        }
+    }
+
+    enum class CaseFoldingKernel
+    {
+        scalar,
+        sse2,
+        avx2,
+        best
+    };
+
+    // src and dest may be the same buffer - folding is done in place then
+    inline void to_lower_ascii(const char* src, char* dest, size_t size, CaseFoldingKernel kernel = CaseFoldingKernel::best)
+    {
+        size_t done = 0;
+
+#ifdef CASE_FOLDING_HAS_AVX2
+        if ((kernel == CaseFoldingKernel::best || kernel == CaseFoldingKernel::avx2) && Details::has_avx2())
+        {
+            done = Details::to_lower_ascii_avx2(src, dest, size);
+            kernel = CaseFoldingKernel::sse2; // remaining tail
+        }
+#endif
+
+#ifdef CASE_FOLDING_HAS_SSE2
+        if (kernel != CaseFoldingKernel::scalar)
+            done += Details::to_lower_ascii_sse2(src + done, dest + done, size - done);
+#endif
+
+        Details::to_lower_ascii_scalar(src + done, dest + done, size - done);
+    }
+
+    inline void to_lower_ascii(std::string_view src, char* dest, CaseFoldingKernel kernel = CaseFoldingKernel::best)
+    {
+        to_lower_ascii(src.data(), dest, src.size(), kernel);
+    }
+
+    inline void to_lower_ascii(std::string& text, CaseFoldingKernel kernel = CaseFoldingKernel::best)
+    {
+        to_lower_ascii(text.data(), text.data(), text.size(), kernel);
+    }
+
+    inline std::string to_lower_ascii_copy(std::string_view text, CaseFoldingKernel kernel = CaseFoldingKernel::best)
+    {
+        std::string result(text.size(), '\0');
+        to_lower_ascii(text, result.data(), kernel);
+        return result;
+    }
+
+    // batch form - the whole byte blob of a column is folded in one pass
+    inline void to_lower_ascii(TokenColumn& column, CaseFoldingKernel kernel = CaseFoldingKernel::best)
+    {
+        to_lower_ascii(column.data(), column.data(), column.bytes().size(), kernel);
+    }
+}
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef CONCURRENT_HASH_MAP_HPP
+#define CONCURRENT_HASH_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "hashing.hpp"
+
+namespace Concurrency
+{
+    ///////////////////////////////////////////////////////////////
+    // string-keyed hash map split into shards, each guarded by its own reader-writer lock
+    // - writers of different shards do not contend, readers may query the map while it is being built
+    // - lookups take std::string_view: keys are owned by the map and indexed by views, so no std::string is built to search
+    // - the shard is chosen by the high bits of the hash, buckets inside the shard by the whole hash
+
+    template <typename Value, typename Hasher = Hashing::WyHash>
+    class ShardedHashMap
+    {
+        struct Slot
+        {
+            std::unique_ptr<const std::string> key; // a stable address for the view that indexes the slot
+            Value value;
+        };
+
+        struct alignas(64) Shard
+        {
+            mutable std::shared_mutex mtx;
+            std::unordered_map<std::string_view, Slot, Hasher> slots;
+        };
+
+        Hasher hasher_;
+        std::vector<Shard> shards_;
+
+        Shard& shard_of(std::string_view key)
+        {
+            return shards_[static_cast<size_t>(((hasher_(key) >> 32) * shards_.size()) >> 32)];
+        }
+
+        const Shard& shard_of(std::string_view key) const
+        {
+            return shards_[static_cast<size_t>(((hasher_(key) >> 32) * shards_.size()) >> 32)];
+        }
+
+    public:
+        // more shards than threads - two writers rarely meet in the same shard
+        static size_t default_no_of_shards()
+        {
+            return 8 * std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        explicit ShardedHashMap(size_t no_of_shards = default_no_of_shards(), const Hasher& hasher = {})
+            : hasher_{hasher}, shards_(std::clamp<size_t>(no_of_shards, 1, size_t{1} << 32))
+        {
+        }
+
+        ShardedHashMap(const ShardedHashMap&) = delete;
+        ShardedHashMap& operator=(const ShardedHashMap&) = delete;
+
+        size_t no_of_shards() const
+        {
+            return shards_.size();
+        }
+
+        // inserts value or calls update(existing value) under the lock of the shard; returns true if inserted
+        template <typename Update>
+        bool insert_or_update(std::string_view key, Value value, Update update)
+        {
+            auto& shard = shard_of(key);
+            std::unique_lock lk{shard.mtx};
+
+            if (auto it = shard.slots.find(key); it != shard.slots.end())
+            {
+                update(it->second.value);
+                return false;
+            }
+
+            auto owned_key = std::make_unique<const std::string>(key);
+            const std::string_view view{*owned_key};
+            shard.slots.emplace(view, Slot{std::move(owned_key), std::move(value)});
+            return true;
+        }
+
+        bool insert(std::string_view key, Value value)
+        {
+            return insert_or_update(key, std::move(value), [](Value&) {});
+        }
+
+        // f(const Value&) is called under the shared lock of the shard; returns false if the key is missing
+        template <typename Visitor>
+        bool visit(std::string_view key, Visitor f) const
+        {
+            const auto& shard = shard_of(key);
+            std::shared_lock lk{shard.mtx};
+
+            auto it = shard.slots.find(key);
+            if (it == shard.slots.end())
+                return false;
+
+            f(it->second.value);
+            return true;
+        }
+
+        std::optional<Value> find(std::string_view key) const
+        {
+            std::optional<Value> result;
+            visit(key, [&](const Value& value) { result = value; });
+            return result;
+        }
+
+        bool contains(std::string_view key) const
+        {
+            return visit(key, [](const Value&) {});
+        }
+
+        bool erase(std::string_view key)
+        {
+            auto& shard = shard_of(key);
+            std::unique_lock lk{shard.mtx};
+
+            return shard.slots.erase(key) == 1;
+        }
+
+        // exact only when no writer runs - shards are counted one after another
+        size_t size() const
+        {
+            size_t size = 0;
+            for (const auto& shard : shards_)
+            {
+                std::shared_lock lk{shard.mtx};
+                size += shard.slots.size();
+            }
+
+            return size;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        void clear()
+        {
+            for (auto& shard : shards_)
+            {
+                std::unique_lock lk{shard.mtx};
+                shard.slots.clear();
+            }
+        }
+
+        // f(std::string_view key, const Value&) for every entry - shards are visited under their shared locks, in parallel with par
+        template <typename ExecutionPolicy, typename Func,
+            typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+        void for_each(ExecutionPolicy&& policy, Func f) const
+        {
+            std::for_each(policy, shards_.begin(), shards_.end(), [&f](const Shard& shard) {
+                std::shared_lock lk{shard.mtx};
+
+                for (const auto& [key, slot] : shard.slots)
+                    f(key, slot.value);
+            });
+        }
+
+        template <typename Func>
+        void for_each(Func f) const
+        {
+            for_each(std::execution::seq, std::move(f));
+        }
+    };
+}
+
+#endif
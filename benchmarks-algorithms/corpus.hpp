@@ -0,0 +1,300 @@
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CORPUS_HAS_MMAP 1
+#endif
+
+namespace Corpus
+{
+    // same set of characters as std::isspace in the "C" locale - the one used by ifstream >> std::string
+    constexpr bool is_space(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    using TokenViews = std::vector<std::string_view>;
+
+    inline void tokenize(std::string_view text, TokenViews& tokens)
+    {
+        const char* pos = text.data();
+        const char* const end = pos + text.size();
+
+        while (pos != end)
+        {
+            while (pos != end && is_space(*pos))
+                ++pos;
+
+            const char* const token_start = pos;
+
+            while (pos != end && !is_space(*pos))
+                ++pos;
+
+            if (pos != token_start)
+                tokens.emplace_back(token_start, static_cast<size_t>(pos - token_start));
+        }
+    }
+
+    inline TokenViews tokenize(std::string_view text)
+    {
+        TokenViews tokens;
+        tokenize(text, tokens);
+        return tokens;
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // parallel tokenizer - chunks are cut at whitespace so no token is split between two chunks
+
+    inline std::vector<std::string_view> split_into_chunks(std::string_view text, size_t no_of_chunks)
+    {
+        std::vector<std::string_view> chunks;
+
+        if (no_of_chunks == 0)
+            no_of_chunks = 1;
+
+        const size_t chunk_size = text.size() / no_of_chunks + 1;
+
+        size_t chunk_start = 0;
+        while (chunk_start < text.size())
+        {
+            size_t chunk_end = std::min(chunk_start + chunk_size, text.size());
+
+            while (chunk_end < text.size() && !is_space(text[chunk_end]))
+                ++chunk_end;
+
+            chunks.push_back(text.substr(chunk_start, chunk_end - chunk_start));
+            chunk_start = chunk_end;
+        }
+
+        return chunks;
+    }
+
+    inline TokenViews tokenize_parallel(std::string_view text, size_t no_of_chunks = std::thread::hardware_concurrency())
+    {
+        const auto chunks = split_into_chunks(text, no_of_chunks);
+
+        std::vector<TokenViews> tokens_in_chunks(chunks.size());
+        std::transform(std::execution::par, chunks.begin(), chunks.end(), tokens_in_chunks.begin(),
+            [](std::string_view chunk) { return tokenize(chunk); });
+
+        std::vector<size_t> offsets(tokens_in_chunks.size() + 1);
+        std::transform_inclusive_scan(tokens_in_chunks.begin(), tokens_in_chunks.end(), std::next(offsets.begin()),
+            std::plus{}, [](const TokenViews& tokens) { return tokens.size(); });
+
+        // parallel algorithms may pass copies of elements - chunks are identified by their indices, not addresses
+        std::vector<size_t> chunk_indices(tokens_in_chunks.size());
+        std::iota(chunk_indices.begin(), chunk_indices.end(), 0);
+
+        TokenViews tokens(offsets.back());
+        std::for_each(std::execution::par, chunk_indices.begin(), chunk_indices.end(), [&](size_t chunk_index) {
+            const auto& chunk_tokens = tokens_in_chunks[chunk_index];
+            std::copy(chunk_tokens.begin(), chunk_tokens.end(), tokens.begin() + static_cast<std::ptrdiff_t>(offsets[chunk_index]));
+        });
+
+        return tokens;
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // read-only view of a whole file - mmap-ed where the platform allows it
+
+    class MappedFile
+    {
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef CORPUS_HAS_MMAP
+        bool is_mapped_ = false;
+#endif
+        std::vector<char> buffer_; // fallback storage when mapping is not possible - moving it never relocates bytes
+
+        MappedFile() = default;
+
+    public:
+        static std::optional<MappedFile> open(const std::string& file_name)
+        {
+            MappedFile file;
+
+#ifdef CORPUS_HAS_MMAP
+            int fd = ::open(file_name.c_str(), O_RDONLY);
+            if (fd == -1)
+                return std::nullopt;
+
+            struct stat file_stat;
+            if (::fstat(fd, &file_stat) == -1)
+            {
+                ::close(fd);
+                return std::nullopt;
+            }
+
+            file.size_ = static_cast<size_t>(file_stat.st_size);
+
+            if (file.size_ > 0)
+            {
+                void* addr = ::mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED)
+                {
+                    ::madvise(addr, file.size_, MADV_SEQUENTIAL);
+                    file.data_ = static_cast<const char*>(addr);
+                    file.is_mapped_ = true;
+                }
+            }
+
+            ::close(fd);
+
+            if (file.is_mapped_ || file.size_ == 0)
+                return file;
+#endif
+
+            std::ifstream input_file{file_name, std::ios::binary};
+
+            if (!input_file)
+                return std::nullopt;
+
+            file.buffer_.assign(std::istreambuf_iterator<char>{input_file}, std::istreambuf_iterator<char>{});
+            file.data_ = file.buffer_.data();
+            file.size_ = file.buffer_.size();
+
+            return file;
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& source) noexcept
+        {
+            swap(source);
+        }
+
+        MappedFile& operator=(MappedFile&& source) noexcept
+        {
+            if (this != &source)
+            {
+                MappedFile temp{std::move(source)};
+                swap(temp);
+            }
+
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+#ifdef CORPUS_HAS_MMAP
+            if (is_mapped_)
+                ::munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+
+        void swap(MappedFile& other) noexcept
+        {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+#ifdef CORPUS_HAS_MMAP
+            std::swap(is_mapped_, other.is_mapped_);
+#endif
+            buffer_.swap(other.buffer_);
+        }
+
+        std::string_view content() const
+        {
+            return {data_, size_};
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // tokens pointing straight into the file; the mapping lives as long as the corpus
+
+    class MappedCorpus
+    {
+        MappedFile file_;
+        TokenViews tokens_;
+
+    public:
+        using const_iterator = TokenViews::const_iterator;
+
+        explicit MappedCorpus(MappedFile file)
+            : file_{std::move(file)}
+            , tokens_{tokenize(file_.content())}
+        {
+        }
+
+        MappedCorpus(MappedFile file, TokenViews tokens)
+            : file_{std::move(file)}
+            , tokens_{std::move(tokens)}
+        {
+        }
+
+        const TokenViews& tokens() const
+        {
+            return tokens_;
+        }
+
+        std::string_view content() const
+        {
+            return file_.content();
+        }
+
+        size_t size() const
+        {
+            return tokens_.size();
+        }
+
+        std::string_view operator[](size_t index) const
+        {
+            return tokens_[index];
+        }
+
+        const_iterator begin() const
+        {
+            return tokens_.begin();
+        }
+
+        const_iterator end() const
+        {
+            return tokens_.end();
+        }
+    };
+
+    inline std::optional<MappedCorpus> load_words_mapped(const std::string& file_name)
+    {
+        auto file = MappedFile::open(file_name);
+
+        if (!file)
+            return std::nullopt;
+
+        return MappedCorpus{std::move(*file)};
+    }
+
+    inline std::optional<MappedCorpus> load_words_mapped_parallel(const std::string& file_name, size_t no_of_chunks = std::thread::hardware_concurrency())
+    {
+        auto file = MappedFile::open(file_name);
+
+        if (!file)
+            return std::nullopt;
+
+        auto tokens = tokenize_parallel(file->content(), no_of_chunks);
+        return MappedCorpus{std::move(*file), std::move(tokens)};
+    }
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef COUNT_MIN_SKETCH_HPP
+#define COUNT_MIN_SKETCH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "hashing.hpp"
+
+namespace Sketches
+{
+    ///////////////////////////////////////////////////////////////
+    // count-min sketch (Cormode, Muthukrishnan 2005) - depth rows of width counters, a key is counted in one counter per row
+    // - estimates never undercount; with width = e / epsilon and depth = ln(1 / delta) they overcount by at most
+    //   epsilon * total count with probability 1 - delta
+    // - conservative update (Estan, Varghese 2002) raises only the counters below the new estimate - much smaller errors
+    //   for skewed streams like natural text
+    // - sketches of the same shape and seed are merged by adding counters, e.g. sketches of different threads
+
+    class CountMinSketch
+    {
+        size_t width_;
+        size_t depth_;
+        uint64_t seed_;
+        uint64_t total_count_ = 0;
+        std::vector<uint64_t> counters_; // row after row
+
+        // Kirsch-Mitzenmacher - the depth hashes are h1 + i * h2 of one 64-bit hash
+        template <typename Func>
+        void for_each_counter(std::string_view key, Func f) const
+        {
+            const uint64_t hash = Hashing::wyhash(key.data(), key.size(), seed_);
+            const auto h1 = static_cast<uint32_t>(hash);
+            const auto h2 = static_cast<uint32_t>(hash >> 32) | 1;
+
+            for (size_t row = 0; row < depth_; ++row)
+                f(row * width_ + (h1 + row * uint64_t{h2}) % width_);
+        }
+
+    public:
+        CountMinSketch(size_t width, size_t depth, uint64_t seed = 0)
+            : width_{width}, depth_{depth}, seed_{seed}
+        {
+            if (width == 0 || depth == 0)
+                throw std::invalid_argument("count-min sketch needs width > 0 and depth > 0");
+
+            counters_.resize(width * depth);
+        }
+
+        // error at most epsilon * total count with probability 1 - delta
+        static CountMinSketch with_error(double epsilon, double delta, uint64_t seed = 0)
+        {
+            if (epsilon <= 0.0 || delta <= 0.0 || delta >= 1.0)
+                throw std::invalid_argument("count-min sketch needs epsilon > 0 and delta in (0, 1)");
+
+            return CountMinSketch{static_cast<size_t>(std::ceil(std::exp(1.0) / epsilon)), static_cast<size_t>(std::ceil(std::log(1.0 / delta))), seed};
+        }
+
+        size_t width() const
+        {
+            return width_;
+        }
+
+        size_t depth() const
+        {
+            return depth_;
+        }
+
+        uint64_t seed() const
+        {
+            return seed_;
+        }
+
+        uint64_t total_count() const
+        {
+            return total_count_;
+        }
+
+        size_t memory_bytes() const
+        {
+            return counters_.size() * sizeof(uint64_t);
+        }
+
+        // conservative update - returns the new estimate
+        uint64_t add(std::string_view key, uint64_t count = 1)
+        {
+            const uint64_t new_estimate = estimate(key) + count;
+
+            for_each_counter(key, [&](size_t index) { counters_[index] = std::max(counters_[index], new_estimate); });
+            total_count_ += count;
+
+            return new_estimate;
+        }
+
+        uint64_t estimate(std::string_view key) const
+        {
+            uint64_t estimate = std::numeric_limits<uint64_t>::max();
+            for_each_counter(key, [&](size_t index) { estimate = std::min(estimate, counters_[index]); });
+            return estimate;
+        }
+
+        // every counter of a key stays >= its count under conservative update, so sums of counters still never undercount
+        void merge(const CountMinSketch& other)
+        {
+            if (width_ != other.width_ || depth_ != other.depth_ || seed_ != other.seed_)
+                throw std::invalid_argument("merged count-min sketches must have the same width, depth and seed");
+
+            for (size_t i = 0; i < counters_.size(); ++i)
+                counters_[i] += other.counters_[i];
+
+            total_count_ += other.total_count_;
+        }
+
+        void clear()
+        {
+            std::fill(counters_.begin(), counters_.end(), 0);
+            total_count_ = 0;
+        }
+    };
+}
+
+#endif
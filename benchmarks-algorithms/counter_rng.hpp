@@ -0,0 +1,142 @@
+#ifndef COUNTER_RNG_HPP
+#define COUNTER_RNG_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace Datasets
+{
+    ///////////////////////////////////////////////////////////////
+    // Philox4x32-10 (Salmon, Moraes, Dror, Shaw - "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011)
+    // - a keyed bijection of 128-bit counters: the n-th random block is computed directly, without the n - 1 before it
+
+    class Philox4x32
+    {
+    public:
+        using Counter = std::array<uint32_t, 4>;
+        using Key = std::array<uint32_t, 2>;
+
+    private:
+        static constexpr uint32_t multiplier_0 = 0xD2511F53;
+        static constexpr uint32_t multiplier_1 = 0xCD9E8D57;
+        static constexpr uint32_t weyl_0 = 0x9E3779B9;
+        static constexpr uint32_t weyl_1 = 0xBB67AE85;
+        static constexpr int no_of_rounds = 10;
+
+        Key key_;
+
+        static Counter round(const Counter& counter, const Key& key)
+        {
+            const uint64_t product_0 = static_cast<uint64_t>(multiplier_0) * counter[0];
+            const uint64_t product_1 = static_cast<uint64_t>(multiplier_1) * counter[2];
+
+            return {static_cast<uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product_1),
+                static_cast<uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product_0)};
+        }
+
+    public:
+        explicit Philox4x32(Key key) : key_{key}
+        {
+        }
+
+        explicit Philox4x32(uint64_t seed) : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+        {
+        }
+
+        Counter operator()(Counter counter) const
+        {
+            Key key = key_;
+
+            for (int i = 0; i < no_of_rounds; ++i)
+            {
+                if (i > 0)
+                {
+                    key[0] += weyl_0;
+                    key[1] += weyl_1;
+                }
+
+                counter = round(counter, key);
+            }
+
+            return counter;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // 64-bit engine over one stream of a counter-based generator - the counter is (stream, block)
+    // - streams are independent, so each chunk of a dataset can be generated from its own stream on any thread
+
+    class CounterEngine
+    {
+        Philox4x32 philox_;
+        uint64_t stream_;
+        uint64_t block_ = 0;
+        std::array<uint64_t, 2> buffer_{};
+        size_t position_ = buffer_.size();
+
+    public:
+        using result_type = uint64_t;
+
+        CounterEngine(uint64_t seed, uint64_t stream) : philox_{seed}, stream_{stream}
+        {
+        }
+
+        static constexpr result_type min()
+        {
+            return 0;
+        }
+
+        static constexpr result_type max()
+        {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        result_type operator()()
+        {
+            if (position_ == buffer_.size())
+            {
+                const auto bits = philox_({static_cast<uint32_t>(stream_), static_cast<uint32_t>(stream_ >> 32),
+                    static_cast<uint32_t>(block_), static_cast<uint32_t>(block_ >> 32)});
+                ++block_;
+
+                buffer_ = {(static_cast<uint64_t>(bits[1]) << 32) | bits[0], (static_cast<uint64_t>(bits[3]) << 32) | bits[2]};
+                position_ = 0;
+            }
+
+            return buffer_[position_++];
+        }
+    };
+
+    // elements generated from one stream - a constant, so that chunks and their streams do not depend on the thread count
+    inline constexpr size_t generate_chunk_size = 1 << 14;
+
+    // elements of the chunk k are generated in order by make_value(engine) with the engine of the stream k
+    // - the output is the same for every policy and thread count, and a prefix does not depend on the size
+    template <typename ExecutionPolicy, typename RandomIt, typename MakeValue,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void parallel_generate(ExecutionPolicy&& policy, RandomIt first, RandomIt last, uint64_t seed, MakeValue make_value)
+    {
+        const auto size = static_cast<size_t>(std::distance(first, last));
+
+        std::vector<size_t> chunks((size + generate_chunk_size - 1) / generate_chunk_size);
+        std::iota(chunks.begin(), chunks.end(), 0);
+
+        std::for_each(policy, chunks.begin(), chunks.end(), [&](size_t chunk) {
+            CounterEngine engine{seed, chunk};
+
+            const size_t chunk_last = std::min((chunk + 1) * generate_chunk_size, size);
+            for (size_t i = chunk * generate_chunk_size; i < chunk_last; ++i)
+                first[i] = make_value(engine);
+        });
+    }
+}
+
+#endif
@@ -0,0 +1,437 @@
+#ifndef DATASETS_HPP
+#define DATASETS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "counter_rng.hpp"
+#include "primes.hpp"
+
+namespace Datasets
+{
+    // every dataset is a function of its parameters and the seed - runs on different machines see the same data
+    inline constexpr uint64_t default_seed = 20211220;
+
+    // std::mt19937_64 produces the same sequence everywhere, std distributions do not - the ones below are portable
+    using Engine = std::mt19937_64;
+
+    // helpers below take any generator of 64-bit values - Engine or CounterEngine
+
+    // uniform in [0, bound) without modulo bias
+    template <typename Generator>
+    uint64_t uniform_below(Generator& engine, uint64_t bound)
+    {
+        const uint64_t threshold = (0 - bound) % bound;
+
+        while (true)
+        {
+            const uint64_t r = engine();
+            if (r >= threshold)
+                return r % bound;
+        }
+    }
+
+    // uniform in [low, high]
+    template <typename Generator>
+    uint64_t uniform_between(Generator& engine, uint64_t low, uint64_t high)
+    {
+        if (high - low == UINT64_MAX)
+            return engine();
+        return low + uniform_below(engine, high - low + 1);
+    }
+
+    // uniform in [0, 1)
+    template <typename Generator>
+    double uniform_real(Generator& engine)
+    {
+        return static_cast<double>(engine() >> 11) * 0x1.0p-53;
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // Zipf distribution over ranks [1, n] - P(k) ~ 1 / k^exponent
+    // - rejection-inversion sampling (Hormann, Derflinger 1996): O(1) per sample, no tables
+
+    class ZipfDistribution
+    {
+        uint64_t n_;
+        double exponent_;
+        double h_integral_x1_;
+        double h_integral_n_;
+        double s_;
+
+        // log(1 + x) / x with a series near 0
+        static double helper1(double x)
+        {
+            return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+        }
+
+        // (exp(x) - 1) / x with a series near 0
+        static double helper2(double x)
+        {
+            return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+        }
+
+        double h(double x) const
+        {
+            return std::exp(-exponent_ * std::log(x));
+        }
+
+        double h_integral(double x) const
+        {
+            const double log_x = std::log(x);
+            return helper2((1.0 - exponent_) * log_x) * log_x;
+        }
+
+        double h_integral_inverse(double x) const
+        {
+            double t = x * (1.0 - exponent_);
+            if (t < -1.0)
+                t = -1.0; // numerical limit
+            return std::exp(helper1(t) * x);
+        }
+
+    public:
+        ZipfDistribution(uint64_t n, double exponent) : n_{n}, exponent_{exponent}
+        {
+            if (n == 0 || exponent <= 0.0)
+                throw std::invalid_argument("Zipf distribution needs n > 0 and exponent > 0");
+
+            h_integral_x1_ = h_integral(1.5) - 1.0;
+            h_integral_n_ = h_integral(static_cast<double>(n) + 0.5);
+            s_ = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+        }
+
+        template <typename Generator>
+        uint64_t operator()(Generator& engine) const
+        {
+            while (true)
+            {
+                const double u = h_integral_n_ + uniform_real(engine) * (h_integral_x1_ - h_integral_n_);
+                const double x = h_integral_inverse(u);
+
+                const auto k = std::clamp<uint64_t>(static_cast<uint64_t>(x + 0.5), 1, n_);
+                const double kd = static_cast<double>(k);
+
+                if (kd - x <= s_ || u >= h_integral(kd + 0.5) - h(kd))
+                    return k;
+            }
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // numbers
+
+    enum class NumberShape
+    {
+        uniform,
+        zipf,
+        sorted,
+        reverse_sorted,
+        nearly_sorted,
+        few_unique,
+        large_primes
+    };
+
+    inline constexpr std::array all_number_shapes = {NumberShape::uniform, NumberShape::zipf, NumberShape::sorted, NumberShape::reverse_sorted,
+        NumberShape::nearly_sorted, NumberShape::few_unique, NumberShape::large_primes};
+
+    inline std::string to_string(NumberShape shape)
+    {
+        switch (shape)
+        {
+        case NumberShape::uniform:
+            return "uniform";
+        case NumberShape::zipf:
+            return "zipf";
+        case NumberShape::sorted:
+            return "sorted";
+        case NumberShape::reverse_sorted:
+            return "reverse sorted";
+        case NumberShape::nearly_sorted:
+            return "nearly sorted";
+        case NumberShape::few_unique:
+            return "few unique";
+        case NumberShape::large_primes:
+            return "large primes";
+        }
+
+        return "unknown";
+    }
+
+    struct NumbersOptions
+    {
+        uint64_t max_value = 20'000;     // values are in [0, max_value]
+        double zipf_exponent = 1.1;      // zipf: value k - 1 has probability ~ 1 / k^exponent
+        double swapped_fraction = 0.01;  // nearly_sorted: random swaps per element
+        size_t no_of_unique_values = 16; // few_unique
+    };
+
+    // large_primes are primes from the upper half of [0, max_value] - the worst case for trial division
+    // - elements are drawn with parallel_generate, auxiliary values from the last stream of the seed,
+    //   so the data depends only on the parameters and the seed - not on the policy nor the number of threads
+    template <typename ExecutionPolicy,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<uint64_t> generate_numbers(ExecutionPolicy&& policy, NumberShape shape, size_t size, const NumbersOptions& options = {},
+        uint64_t seed = default_seed)
+    {
+        constexpr uint64_t auxiliary_stream = std::numeric_limits<uint64_t>::max();
+
+        std::vector<uint64_t> numbers(size);
+
+        auto uniform = [&](CounterEngine& engine) { return uniform_between(engine, 0, options.max_value); };
+
+        switch (shape)
+        {
+        case NumberShape::uniform:
+            parallel_generate(policy, numbers.begin(), numbers.end(), seed, uniform);
+            break;
+
+        case NumberShape::zipf:
+        {
+            const ZipfDistribution zipf{options.max_value + 1, options.zipf_exponent};
+            parallel_generate(policy, numbers.begin(), numbers.end(), seed, [&](CounterEngine& engine) { return zipf(engine) - 1; });
+            break;
+        }
+
+        case NumberShape::sorted:
+        case NumberShape::reverse_sorted:
+        case NumberShape::nearly_sorted:
+            parallel_generate(policy, numbers.begin(), numbers.end(), seed, uniform);
+            std::sort(policy, numbers.begin(), numbers.end());
+
+            if (shape == NumberShape::reverse_sorted)
+                std::reverse(policy, numbers.begin(), numbers.end());
+
+            if (shape == NumberShape::nearly_sorted && size > 1)
+            {
+                CounterEngine engine{seed, auxiliary_stream};
+
+                const auto no_of_swaps = static_cast<size_t>(options.swapped_fraction * static_cast<double>(size));
+                for (size_t i = 0; i < no_of_swaps; ++i)
+                {
+                    // two statements - the evaluation order of arguments is unspecified
+                    const size_t first = uniform_below(engine, size);
+                    const size_t second = uniform_below(engine, size);
+                    std::swap(numbers[first], numbers[second]);
+                }
+            }
+            break;
+
+        case NumberShape::few_unique:
+        {
+            std::vector<uint64_t> values(std::max<size_t>(options.no_of_unique_values, 1));
+            CounterEngine values_engine{seed, auxiliary_stream};
+            std::generate(values.begin(), values.end(), [&] { return uniform(values_engine); });
+
+            parallel_generate(policy, numbers.begin(), numbers.end(), seed,
+                [&](CounterEngine& engine) { return values[uniform_below(engine, values.size())]; });
+            break;
+        }
+
+        case NumberShape::large_primes:
+        {
+            // Bertrand's postulate - there is a prime in (n/2, n] for n >= 2
+            if (options.max_value < 2)
+                throw std::invalid_argument("no primes in the range");
+
+            const uint64_t low = options.max_value / 2 + 1;
+            parallel_generate(policy, numbers.begin(), numbers.end(), seed, [&](CounterEngine& engine) {
+                while (true)
+                {
+                    const uint64_t candidate = uniform_between(engine, low, options.max_value);
+                    if (Primes::is_prime(candidate))
+                        return candidate;
+                }
+            });
+            break;
+        }
+        }
+
+        return numbers;
+    }
+
+    inline std::vector<uint64_t> generate_numbers(NumberShape shape, size_t size, const NumbersOptions& options = {}, uint64_t seed = default_seed)
+    {
+        return generate_numbers(std::execution::seq, shape, size, options, seed);
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // words
+
+    enum class LengthShape
+    {
+        fixed,   // max_length
+        uniform, // [min_length, max_length]
+        zipf     // short words are the most frequent - like in natural language
+    };
+
+    struct WordsOptions
+    {
+        LengthShape lengths = LengthShape::uniform;
+        size_t min_length = 1;
+        size_t max_length = 12;
+        double uppercase_fraction = 0.1; // letters in upper case - work for case folding
+
+        // prefix sharing: prefixed_fraction of words starts with one of no_of_prefixes prefixes of prefix_length letters;
+        // prefixes are chosen with a Zipf distribution - long shared prefixes are the worst case for comparisons and MSD radix sort
+        double prefixed_fraction = 0.0;
+        size_t no_of_prefixes = 8;
+        size_t prefix_length = 8;
+
+        size_t no_of_unique_words = 0; // > 0 - words are drawn from a vocabulary of that size
+    };
+
+    enum class WordShape
+    {
+        random,
+        natural_lengths,
+        shared_prefixes,
+        long_words,
+        few_unique
+    };
+
+    inline constexpr std::array all_word_shapes = {WordShape::random, WordShape::natural_lengths, WordShape::shared_prefixes, WordShape::long_words, WordShape::few_unique};
+
+    inline std::string to_string(WordShape shape)
+    {
+        switch (shape)
+        {
+        case WordShape::random:
+            return "random";
+        case WordShape::natural_lengths:
+            return "natural lengths";
+        case WordShape::shared_prefixes:
+            return "shared prefixes";
+        case WordShape::long_words:
+            return "long words";
+        case WordShape::few_unique:
+            return "few unique";
+        }
+
+        return "unknown";
+    }
+
+    inline WordsOptions words_options(WordShape shape)
+    {
+        WordsOptions options;
+
+        switch (shape)
+        {
+        case WordShape::random:
+            break;
+        case WordShape::natural_lengths:
+            options.lengths = LengthShape::zipf;
+            options.max_length = 20;
+            break;
+        case WordShape::shared_prefixes:
+            options.min_length = 12;
+            options.max_length = 20;
+            options.prefixed_fraction = 0.9;
+            options.no_of_prefixes = 4;
+            options.prefix_length = 10;
+            break;
+        case WordShape::long_words:
+            options.min_length = 32;
+            options.max_length = 64;
+            break;
+        case WordShape::few_unique:
+            options.no_of_unique_words = 64;
+            break;
+        }
+
+        return options;
+    }
+
+    namespace Details
+    {
+        inline char random_letter(Engine& engine, double uppercase_fraction)
+        {
+            const char letter = static_cast<char>('a' + uniform_below(engine, 26));
+            return uniform_real(engine) < uppercase_fraction ? static_cast<char>(letter - 'a' + 'A') : letter;
+        }
+
+        inline std::string random_word(Engine& engine, const WordsOptions& options, const std::vector<std::string>& prefixes,
+            const std::optional<ZipfDistribution>& lengths, const std::optional<ZipfDistribution>& prefix_ranks)
+        {
+            size_t length = options.max_length;
+            if (options.lengths == LengthShape::uniform)
+                length = uniform_between(engine, options.min_length, options.max_length);
+            else if (options.lengths == LengthShape::zipf)
+                length = options.min_length + (*lengths)(engine) - 1;
+
+            std::string word;
+            word.reserve(length);
+
+            if (!prefixes.empty() && uniform_real(engine) < options.prefixed_fraction)
+                word = prefixes[(*prefix_ranks)(engine) - 1].substr(0, length);
+
+            while (word.size() < length)
+                word += random_letter(engine, options.uppercase_fraction);
+
+            return word;
+        }
+    }
+
+    inline std::vector<std::string> generate_words(size_t size, const WordsOptions& options = {}, uint64_t seed = default_seed)
+    {
+        if (options.min_length > options.max_length)
+            throw std::invalid_argument("min_length > max_length");
+
+        Engine engine{seed};
+
+        std::optional<ZipfDistribution> lengths;
+        if (options.lengths == LengthShape::zipf)
+            lengths.emplace(options.max_length - options.min_length + 1, 1.0);
+
+        std::vector<std::string> prefixes;
+        std::optional<ZipfDistribution> prefix_ranks;
+        if (options.prefixed_fraction > 0.0 && options.no_of_prefixes > 0)
+        {
+            for (size_t i = 0; i < options.no_of_prefixes; ++i)
+            {
+                std::string prefix;
+                for (size_t j = 0; j < options.prefix_length; ++j)
+                    prefix += Details::random_letter(engine, options.uppercase_fraction);
+                prefixes.push_back(std::move(prefix));
+            }
+
+            prefix_ranks.emplace(options.no_of_prefixes, 1.0);
+        }
+
+        auto next_word = [&] { return Details::random_word(engine, options, prefixes, lengths, prefix_ranks); };
+
+        std::vector<std::string> words(size);
+
+        if (options.no_of_unique_words > 0)
+        {
+            std::vector<std::string> vocabulary(options.no_of_unique_words);
+            std::generate(vocabulary.begin(), vocabulary.end(), next_word);
+            std::generate(words.begin(), words.end(), [&] { return vocabulary[uniform_below(engine, vocabulary.size())]; });
+        }
+        else
+        {
+            std::generate(words.begin(), words.end(), next_word);
+        }
+
+        return words;
+    }
+
+    inline std::vector<std::string> generate_words(WordShape shape, size_t size, uint64_t seed = default_seed)
+    {
+        return generate_words(size, words_options(shape), seed);
+    }
+}
+
+#endif
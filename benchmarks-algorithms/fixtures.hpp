@@ -0,0 +1,172 @@
+#ifndef FIXTURES_HPP
+#define FIXTURES_HPP
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace Benchmarking
+{
+    ///////////////////////////////////////////////////////////////
+    // named benchmark fixtures - built lazily, once per process, on first use or on a background thread
+    // - a run filtered to a few test cases pays only for the fixtures they use
+
+    class FixtureRegistry
+    {
+        struct Fixture
+        {
+            std::type_index type;
+            std::function<std::shared_ptr<const void>()> make;
+            std::once_flag is_built_flag;
+            std::shared_ptr<const void> value; // written once under is_built_flag
+            std::atomic<bool> is_built{false};
+
+            Fixture(std::type_index type, std::function<std::shared_ptr<const void>()> make) : type{type}, make{std::move(make)}
+            {
+            }
+        };
+
+        mutable std::mutex mtx_fixtures_;
+        std::map<std::string, std::unique_ptr<Fixture>> fixtures_; // entries are never removed - references stay valid
+        std::vector<std::future<void>> prefetches_;
+
+        Fixture& find(const std::string& name) const
+        {
+            std::lock_guard lk{mtx_fixtures_};
+
+            auto it = fixtures_.find(name);
+            if (it == fixtures_.end())
+                throw std::out_of_range("unknown fixture: " + name);
+
+            return *it->second;
+        }
+
+        // concurrent callers wait for the first one - if make throws, the next caller tries again
+        static void build(Fixture& fixture)
+        {
+            std::call_once(fixture.is_built_flag, [&fixture] {
+                fixture.value = fixture.make();
+                fixture.is_built.store(true, std::memory_order_release);
+            });
+        }
+
+    public:
+        FixtureRegistry() = default;
+        FixtureRegistry(const FixtureRegistry&) = delete;
+        FixtureRegistry& operator=(const FixtureRegistry&) = delete;
+
+        // waits for prefetches still running
+        ~FixtureRegistry()
+        {
+            wait_for_prefetches();
+        }
+
+        template <typename T, typename Factory>
+        void add(const std::string& name, Factory factory)
+        {
+            std::lock_guard lk{mtx_fixtures_};
+
+            auto make = [factory = std::move(factory)]() -> std::shared_ptr<const void> { return std::make_shared<const T>(factory()); };
+            if (!fixtures_.try_emplace(name, std::make_unique<Fixture>(std::type_index{typeid(T)}, std::move(make))).second)
+                throw std::invalid_argument("fixture already registered: " + name);
+        }
+
+        // builds the fixture on the first call - throws std::out_of_range for unknown names and std::invalid_argument for a wrong type
+        template <typename T>
+        const T& get(const std::string& name)
+        {
+            auto& fixture = find(name);
+
+            if (fixture.type != std::type_index{typeid(T)})
+                throw std::invalid_argument("fixture " + name + " is not of type " + typeid(T).name());
+
+            build(fixture);
+            return *static_cast<const T*>(fixture.value.get());
+        }
+
+        // starts building on a background thread - errors are reported again by get()
+        void prefetch(const std::string& name)
+        {
+            auto& fixture = find(name);
+
+            std::lock_guard lk{mtx_fixtures_};
+            prefetches_.push_back(std::async(std::launch::async, [&fixture] {
+                try
+                {
+                    build(fixture);
+                }
+                catch (...)
+                {
+                }
+            }));
+        }
+
+        void prefetch_all()
+        {
+            for (const auto& name : names())
+                prefetch(name);
+        }
+
+        void wait_for_prefetches()
+        {
+            std::vector<std::future<void>> prefetches;
+            {
+                std::lock_guard lk{mtx_fixtures_};
+                prefetches.swap(prefetches_);
+            }
+
+            for (auto& prefetch : prefetches)
+                prefetch.wait();
+        }
+
+        bool is_built(const std::string& name) const
+        {
+            return find(name).is_built.load(std::memory_order_acquire);
+        }
+
+        std::vector<std::string> names() const
+        {
+            std::lock_guard lk{mtx_fixtures_};
+
+            std::vector<std::string> names;
+            for (const auto& [name, fixture] : fixtures_)
+                names.push_back(name);
+
+            return names;
+        }
+    };
+
+    inline FixtureRegistry& fixtures()
+    {
+        static FixtureRegistry registry;
+        return registry;
+    }
+
+    template <typename T>
+    const T& fixture(const std::string& name)
+    {
+        return fixtures().get<T>(name);
+    }
+
+    // registration at namespace scope - like TEST_CASE, nothing is built during the static initialization
+    template <typename T>
+    struct RegisterFixture
+    {
+        template <typename Factory>
+        RegisterFixture(const std::string& name, Factory factory)
+        {
+            fixtures().add<T>(name, std::move(factory));
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef HASHING_HPP
+#define HASHING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "token_column.hpp"
+
+namespace Hashing
+{
+    namespace Details
+    {
+        // unaligned little-endian reads
+        inline uint64_t read64(const uint8_t* p)
+        {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t read32(const uint8_t* p)
+        {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        // 1..3 bytes - first, middle and last byte
+        inline uint64_t read_small(const uint8_t* p, size_t length)
+        {
+            return (uint64_t{p[0]} << 16) | (uint64_t{p[length >> 1]} << 8) | p[length - 1];
+        }
+
+        // 64 x 64 -> 128 bit multiplication, the halves in a and b
+        inline void multiply(uint64_t& a, uint64_t& b)
+        {
+#if defined(__SIZEOF_INT128__)
+            const auto product = static_cast<unsigned __int128>(a) * b;
+            a = static_cast<uint64_t>(product);
+            b = static_cast<uint64_t>(product >> 64);
+#else
+            const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+            const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+            uint64_t carry = t < rl;
+            const uint64_t lo = t + (rm1 << 32);
+            carry += lo < t;
+            const uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+            a = lo;
+            b = hi;
+#endif
+        }
+
+        inline uint64_t mix(uint64_t a, uint64_t b)
+        {
+            multiply(a, b);
+            return a ^ b;
+        }
+
+        inline constexpr uint64_t wyhash_secret[4] = {0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47};
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // wyhash (Wang Yi, final version 4) - 64-bit, seedable, one 128-bit multiplication per 16 bytes
+    // - tokens up to 16 bytes are read with at most four loads and no loop
+
+    inline uint64_t wyhash(const void* key, size_t length, uint64_t seed = 0)
+    {
+        using namespace Details;
+        const auto& secret = wyhash_secret;
+
+        const auto* p = static_cast<const uint8_t*>(key);
+        seed ^= mix(seed ^ secret[0], secret[1]);
+
+        uint64_t a, b;
+        if (length <= 16)
+        {
+            if (length >= 4)
+            {
+                const size_t shift = (length >> 3) << 2;
+                a = (read32(p) << 32) | read32(p + shift);
+                b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+            }
+            else if (length > 0)
+            {
+                a = read_small(p, length);
+                b = 0;
+            }
+            else
+            {
+                a = b = 0;
+            }
+        }
+        else
+        {
+            size_t i = length;
+            if (i > 48)
+            {
+                uint64_t seed1 = seed, seed2 = seed;
+                do
+                {
+                    seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+                    seed1 = mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ seed1);
+                    seed2 = mix(read64(p + 32) ^ secret[3], read64(p + 40) ^ seed2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= seed1 ^ seed2;
+            }
+
+            while (i > 16)
+            {
+                seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+
+            a = read64(p + i - 16);
+            b = read64(p + i - 8);
+        }
+
+        a ^= secret[1];
+        b ^= seed;
+        multiply(a, b);
+        return mix(a ^ secret[0] ^ length, b ^ secret[1]);
+    }
+
+    // FNV-1a - byte at a time, the baseline for short keys
+    inline uint64_t fnv1a(const void* key, size_t length, uint64_t seed = 0)
+    {
+        const auto* p = static_cast<const uint8_t*>(key);
+
+        uint64_t hash = 0xcbf29ce484222325 ^ seed;
+        for (size_t i = 0; i < length; ++i)
+            hash = (hash ^ p[i]) * 0x100000001b3;
+
+        return hash;
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // hashers - seedable function objects, std::hash compatible: keys of std::unordered_set<std::string, Hashing::WyHash>
+    // - is_transparent allows lookups by std::string_view where heterogeneous lookup is supported
+
+    struct WyHash
+    {
+        using is_transparent = void;
+
+        uint64_t seed = 0;
+
+        uint64_t operator()(std::string_view text) const
+        {
+            return wyhash(text.data(), text.size(), seed);
+        }
+    };
+
+    struct Fnv1a
+    {
+        using is_transparent = void;
+
+        uint64_t seed = 0;
+
+        uint64_t operator()(std::string_view text) const
+        {
+            return fnv1a(text.data(), text.size(), seed);
+        }
+    };
+
+    // any hasher of std::string_view as a std::hash of T - e.g. StdHash<std::string, WyHash>
+    template <typename T, typename Hasher = WyHash>
+    struct StdHash
+    {
+        using is_transparent = void;
+
+        Hasher hasher{};
+
+        size_t operator()(const T& value) const
+        {
+            return static_cast<size_t>(hasher(std::string_view(value)));
+        }
+
+        size_t operator()(std::string_view text) const
+        {
+            return static_cast<size_t>(hasher(text));
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // bulk hashing of a token column - hashes[i] = hasher(column[i])
+    // - four tokens per step are hashed independently, so multiplications of neighbouring tokens overlap in the pipeline
+    // - offsets are read once per token and bytes sequentially, without building string_views through the iterator
+
+    namespace Details
+    {
+        template <typename Hasher>
+        void hash_tokens(const Corpus::TokenColumn& column, size_t first, size_t last, uint64_t* hashes, const Hasher& hasher)
+        {
+            const char* bytes = column.data();
+            const uint32_t* offsets = column.offsets().data();
+
+            auto token = [&](size_t i) { return std::string_view{bytes + offsets[i], offsets[i + 1] - offsets[i]}; };
+
+            size_t i = first;
+            for (; i + 4 <= last; i += 4)
+            {
+                const uint64_t h0 = hasher(token(i));
+                const uint64_t h1 = hasher(token(i + 1));
+                const uint64_t h2 = hasher(token(i + 2));
+                const uint64_t h3 = hasher(token(i + 3));
+
+                hashes[i] = h0;
+                hashes[i + 1] = h1;
+                hashes[i + 2] = h2;
+                hashes[i + 3] = h3;
+            }
+
+            for (; i < last; ++i)
+                hashes[i] = hasher(token(i));
+        }
+    }
+
+    inline constexpr size_t bulk_chunk_size = 1 << 14;
+
+    template <typename ExecutionPolicy, typename Hasher = WyHash,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<uint64_t> hash_tokens(ExecutionPolicy&& policy, const Corpus::TokenColumn& column, const Hasher& hasher = {})
+    {
+        std::vector<uint64_t> hashes(column.size());
+
+        std::vector<size_t> chunks((column.size() + bulk_chunk_size - 1) / bulk_chunk_size);
+        std::iota(chunks.begin(), chunks.end(), 0);
+
+        std::for_each(policy, chunks.begin(), chunks.end(), [&](size_t chunk) {
+            const size_t first = chunk * bulk_chunk_size;
+            Details::hash_tokens(column, first, std::min(first + bulk_chunk_size, column.size()), hashes.data(), hasher);
+        });
+
+        return hashes;
+    }
+
+    template <typename Hasher = WyHash>
+    std::vector<uint64_t> hash_tokens(const Corpus::TokenColumn& column, const Hasher& hasher = {})
+    {
+        std::vector<uint64_t> hashes(column.size());
+        Details::hash_tokens(column, 0, column.size(), hashes.data(), hasher);
+        return hashes;
+    }
+}
+
+#endif
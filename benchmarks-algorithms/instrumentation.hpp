@@ -0,0 +1,104 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "allocation_counter.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+
+namespace Benchmarking
+{
+    namespace Details
+    {
+        // every call of fun is timed separately - the timer adds ~2 x 20 ns to each iteration
+        template <typename Fun>
+        auto timed_iterations(Fun& fun, LatencyHistogram& histogram)
+        {
+            return [&fun, &histogram] {
+                const auto start = std::chrono::steady_clock::now();
+
+                if constexpr (std::is_void_v<std::invoke_result_t<Fun&>>)
+                {
+                    fun();
+                    histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+                }
+                else
+                {
+                    auto result = fun();
+                    histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+                    return result;
+                }
+            };
+        }
+    }
+
+    // drop-in for meter.measure(fun) in BENCHMARK_ADVANCED - hardware counters (--perf-counters), allocations (--allocations)
+    // and latency histograms (--latency-histograms) are collected for fun only, not for the setup of the benchmark
+    template <typename Meter, typename Fun>
+    void measure(Meter& meter, size_t no_of_elements, Fun&& fun)
+    {
+        auto& perf = perf_recorder();
+        auto& allocations = allocation_recorder();
+        auto& latencies = histogram_recorder();
+
+        std::optional<PerfCounters> counters;
+        if (perf.is_enabled && perf.current)
+        {
+            counters.emplace();
+
+            if (!counters->is_available())
+            {
+                perf.error = counters->error();
+                perf.is_enabled = false;
+                counters.reset();
+            }
+        }
+
+        const bool count_allocations = allocations.is_enabled && allocations.current;
+        AllocationCounts allocations_before;
+        int64_t live_bytes_before = 0;
+
+        if (count_allocations)
+        {
+            reset_peak_live_bytes();
+            live_bytes_before = live_bytes();
+            allocations_before = allocation_counts();
+            start_counting_allocations();
+        }
+
+        if (counters)
+            counters->start();
+
+        if (latencies.is_enabled && latencies.current)
+            meter.measure(Details::timed_iterations(fun, *latencies.current));
+        else
+            meter.measure(std::forward<Fun>(fun));
+
+        if (counters)
+        {
+            auto& sample = *perf.current;
+            sample.counts += counters->stop();
+            sample.runs += static_cast<uint64_t>(meter.runs());
+            sample.no_of_elements = no_of_elements;
+        }
+
+        if (count_allocations)
+        {
+            stop_counting_allocations();
+
+            auto& sample = *allocations.current;
+            sample.counts += allocation_counts() - allocations_before;
+            sample.runs += static_cast<uint64_t>(meter.runs());
+            sample.peak_live_bytes = std::max(sample.peak_live_bytes, peak_live_bytes() - live_bytes_before);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Benchmarking
+{
+    ///////////////////////////////////////////////////////////////
+    // HDR histogram - log-bucketed counts with a fixed relative precision
+    // - each power of two range is split into 2 * 10^significant_digits linear sub-buckets
+    // - recording is O(1) and two histograms with the same layout can be merged
+
+    class LatencyHistogram
+    {
+        int64_t lowest_trackable_;
+        int64_t highest_trackable_;
+        int significant_digits_;
+
+        int unit_magnitude_;
+        int sub_bucket_half_count_magnitude_;
+        int64_t sub_bucket_count_;
+        int64_t sub_bucket_half_count_;
+        int64_t sub_bucket_mask_;
+        int bucket_count_;
+
+        std::vector<uint64_t> counts_;
+        uint64_t total_count_ = 0;
+        int64_t min_ = std::numeric_limits<int64_t>::max();
+        int64_t max_ = 0;
+
+        static int floor_log2(uint64_t value)
+        {
+            int log = -1;
+            for (; value != 0; value >>= 1)
+                ++log;
+            return log;
+        }
+
+        int bucket_index(int64_t value) const
+        {
+            const int pow2_ceiling = floor_log2(static_cast<uint64_t>(value | sub_bucket_mask_)) + 1;
+            return pow2_ceiling - unit_magnitude_ - (sub_bucket_half_count_magnitude_ + 1);
+        }
+
+        int64_t sub_bucket_index(int64_t value, int bucket) const
+        {
+            return value >> (bucket + unit_magnitude_);
+        }
+
+        size_t counts_index(int bucket, int64_t sub_bucket) const
+        {
+            return static_cast<size_t>((static_cast<int64_t>(bucket + 1) << sub_bucket_half_count_magnitude_) + (sub_bucket - sub_bucket_half_count_));
+        }
+
+        size_t counts_index_of(int64_t value) const
+        {
+            const int bucket = bucket_index(value);
+            return counts_index(bucket, sub_bucket_index(value, bucket));
+        }
+
+        int64_t value_at_index(size_t index) const
+        {
+            int bucket = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+            int64_t sub_bucket = static_cast<int64_t>(index & static_cast<size_t>(sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+
+            if (bucket < 0)
+            {
+                sub_bucket -= sub_bucket_half_count_;
+                bucket = 0;
+            }
+
+            return sub_bucket << (bucket + unit_magnitude_);
+        }
+
+        int64_t size_of_equivalent_range(int64_t value) const
+        {
+            const int bucket = bucket_index(value);
+            const int64_t sub_bucket = sub_bucket_index(value, bucket);
+            const int adjusted_bucket = sub_bucket >= sub_bucket_count_ ? bucket + 1 : bucket;
+            return int64_t{1} << (unit_magnitude_ + adjusted_bucket);
+        }
+
+    public:
+        static constexpr int min_significant_digits = 1;
+        static constexpr int max_significant_digits = 5;
+
+        // values are expected in [lowest_trackable, highest_trackable] - e.g. nanoseconds from 1 ns to 1 hour
+        explicit LatencyHistogram(int significant_digits = 3, int64_t lowest_trackable = 1, int64_t highest_trackable = 3'600'000'000'000)
+            : lowest_trackable_{lowest_trackable}, highest_trackable_{highest_trackable}, significant_digits_{significant_digits}
+        {
+            if (significant_digits < min_significant_digits || significant_digits > max_significant_digits)
+                throw std::invalid_argument("significant digits must be in [" + std::to_string(min_significant_digits) + ", "
+                    + std::to_string(max_significant_digits) + "]");
+            if (lowest_trackable < 1 || highest_trackable < 2 * lowest_trackable)
+                throw std::invalid_argument("invalid range of trackable values");
+
+            const int64_t largest_single_unit_resolution = 2 * static_cast<int64_t>(std::pow(10, significant_digits));
+            const int sub_bucket_count_magnitude = floor_log2(static_cast<uint64_t>(largest_single_unit_resolution - 1)) + 1;
+
+            sub_bucket_half_count_magnitude_ = std::max(sub_bucket_count_magnitude, 1) - 1;
+            unit_magnitude_ = floor_log2(static_cast<uint64_t>(lowest_trackable));
+            sub_bucket_count_ = int64_t{1} << (sub_bucket_half_count_magnitude_ + 1);
+            sub_bucket_half_count_ = sub_bucket_count_ / 2;
+            sub_bucket_mask_ = (sub_bucket_count_ - 1) << unit_magnitude_;
+
+            int64_t smallest_untrackable = sub_bucket_count_ << unit_magnitude_;
+            bucket_count_ = 1;
+            while (smallest_untrackable <= highest_trackable)
+            {
+                if (smallest_untrackable > std::numeric_limits<int64_t>::max() / 2)
+                {
+                    ++bucket_count_;
+                    break;
+                }
+                smallest_untrackable <<= 1;
+                ++bucket_count_;
+            }
+
+            counts_.resize(static_cast<size_t>((bucket_count_ + 1) * sub_bucket_half_count_));
+        }
+
+        // values outside of the trackable range are clamped
+        void record(int64_t value, uint64_t count = 1)
+        {
+            value = std::clamp(value, int64_t{0}, highest_trackable_);
+
+            counts_[counts_index_of(value)] += count;
+            total_count_ += count;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        bool has_same_layout(const LatencyHistogram& other) const
+        {
+            return lowest_trackable_ == other.lowest_trackable_ && highest_trackable_ == other.highest_trackable_
+                && significant_digits_ == other.significant_digits_;
+        }
+
+        // histograms of the same layout only - e.g. recorded by different threads or runs
+        void merge(const LatencyHistogram& other)
+        {
+            if (!has_same_layout(other))
+                throw std::invalid_argument("merged histograms must have the same layout");
+
+            for (size_t i = 0; i < counts_.size(); ++i)
+                counts_[i] += other.counts_[i];
+
+            total_count_ += other.total_count_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+
+        void reset()
+        {
+            std::fill(counts_.begin(), counts_.end(), 0);
+            total_count_ = 0;
+            min_ = std::numeric_limits<int64_t>::max();
+            max_ = 0;
+        }
+
+        uint64_t total_count() const
+        {
+            return total_count_;
+        }
+
+        int significant_digits() const
+        {
+            return significant_digits_;
+        }
+
+        int64_t min() const
+        {
+            return total_count_ > 0 ? min_ : 0;
+        }
+
+        int64_t max() const
+        {
+            return max_;
+        }
+
+        int64_t lowest_equivalent(int64_t value) const
+        {
+            const int bucket = bucket_index(value);
+            return sub_bucket_index(value, bucket) << (bucket + unit_magnitude_);
+        }
+
+        int64_t highest_equivalent(int64_t value) const
+        {
+            return lowest_equivalent(value) + size_of_equivalent_range(value) - 1;
+        }
+
+        double mean() const
+        {
+            if (total_count_ == 0)
+                return 0.0;
+
+            double sum = 0.0;
+            for (size_t i = 0; i < counts_.size(); ++i)
+            {
+                if (counts_[i] == 0)
+                    continue;
+
+                const int64_t value = value_at_index(i);
+                sum += static_cast<double>(counts_[i]) * static_cast<double>(lowest_equivalent(value) + size_of_equivalent_range(value) / 2);
+            }
+
+            return sum / static_cast<double>(total_count_);
+        }
+
+        // the highest value equivalent to the value at given percentile (0 - 100)
+        int64_t value_at_percentile(double percentile) const
+        {
+            if (total_count_ == 0)
+                return 0;
+
+            percentile = std::clamp(percentile, 0.0, 100.0);
+            // rounded like HdrHistogram - ceil would turn 99.9% of 1000 into 1000 because of the floating point error
+            const auto count_at_percentile = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total_count_) + 0.5));
+
+            uint64_t count = 0;
+            for (size_t i = 0; i < counts_.size(); ++i)
+            {
+                count += counts_[i];
+
+                if (count >= count_at_percentile)
+                    return std::min(highest_equivalent(value_at_index(i)), max_);
+            }
+
+            return max_;
+        }
+
+        ///////////////////////////////////////////////////////////////
+        // text dump of non-empty buckets - layout first, then index:count pairs
+
+        std::string dump() const
+        {
+            std::ostringstream out;
+            out << "HDR " << significant_digits_ << " " << lowest_trackable_ << " " << highest_trackable_ << " " << min() << " " << max_;
+
+            for (size_t i = 0; i < counts_.size(); ++i)
+                if (counts_[i] != 0)
+                    out << " " << i << ":" << counts_[i];
+
+            return out.str();
+        }
+
+        // throws std::invalid_argument for text not created by dump()
+        static LatencyHistogram parse(const std::string& text)
+        {
+            std::istringstream in{text};
+
+            std::string tag;
+            int significant_digits;
+            int64_t lowest_trackable, highest_trackable, min, max;
+            if (!(in >> tag >> significant_digits >> lowest_trackable >> highest_trackable >> min >> max) || tag != "HDR")
+                throw std::invalid_argument("not a histogram dump");
+
+            LatencyHistogram histogram{significant_digits, lowest_trackable, highest_trackable};
+
+            size_t index;
+            char separator;
+            uint64_t count;
+            while (in >> index >> separator >> count)
+            {
+                if (separator != ':' || index >= histogram.counts_.size())
+                    throw std::invalid_argument("corrupted histogram dump");
+
+                histogram.counts_[index] += count;
+                histogram.total_count_ += count;
+            }
+
+            if (!in.eof())
+                throw std::invalid_argument("corrupted histogram dump");
+
+            if (histogram.total_count_ > 0)
+            {
+                histogram.min_ = min;
+                histogram.max_ = max;
+            }
+
+            return histogram;
+        }
+    };
+
+    // percentiles reported for every benchmark
+    inline constexpr double reported_percentiles[] = {50.0, 90.0, 99.0, 99.9};
+
+    ///////////////////////////////////////////////////////////////
+    // collecting latencies of Catch benchmarks
+
+    struct HistogramRecorder
+    {
+        bool is_enabled = false;                 // set by --latency-histograms
+        int significant_digits = 3;              // set by --histogram-digits
+        std::optional<LatencyHistogram> current; // reset by the results listener when a benchmark starts
+    };
+
+    inline HistogramRecorder& histogram_recorder()
+    {
+        static HistogramRecorder recorder;
+        return recorder;
+    }
+}
+
+#endif
@@ -1,4 +1,145 @@
-#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_RUNNER
 #define CATCH_CONFIG_ENABLE_BENCHMARKING
 
-#include "catch.hpp"
\ No newline at end of file
+#include "catch.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "adaptive_policy.hpp"
+#include "benchmark_results.hpp"
+#include "fixtures.hpp"
+#include "scaling_sweep.hpp"
+#include "tracer.hpp"
+
+int main(int argc, char* argv[])
+{
+    Catch::Session session;
+
+    std::string json_file_name;
+    std::string csv_file_name;
+    std::string baseline_file_name;
+    double regression_threshold = 0.05;
+    double significance_level = 0.05;
+    bool collect_counters = false;
+    bool count_allocations = false;
+    auto& latencies = Benchmarking::histogram_recorder();
+    std::string trace_file_name;
+    bool prefetch_fixtures = false;
+    std::string adaptive_profile_file_name = Concurrency::AdaptivePolicy::default_profile_file_name;
+    auto& sweep = Benchmarking::sweep_config();
+
+    using namespace Catch::clara;
+    session.cli(session.cli()
+        | Opt(json_file_name, "file")["--benchmark-json"]("write samples and statistics of every benchmark to a JSON file")
+        | Opt(csv_file_name, "file")["--benchmark-csv"]("write samples and statistics of every benchmark to a CSV file")
+        | Opt(baseline_file_name, "file")["--benchmark-baseline"]("compare with results stored by --benchmark-json; slowdowns fail the run")
+        | Opt(regression_threshold, "ratio")["--benchmark-threshold"]("minimal slowdown reported as a regression (default: 0.05)")
+        | Opt(significance_level, "alpha")["--benchmark-alpha"]("significance level of the Mann-Whitney test (default: 0.05)")
+        | Opt(collect_counters)["--perf-counters"]("collect cycles, instructions, cache and branch misses with perf_event_open")
+        | Opt(count_allocations)["--allocations"]("count allocations, bytes allocated and peak live bytes per iteration")
+        | Opt(latencies.is_enabled)["--latency-histograms"]("record every iteration in an HDR histogram and report percentiles")
+        | Opt([&](int digits) {
+              using Histogram = Benchmarking::LatencyHistogram;
+              if (digits < Histogram::min_significant_digits || digits > Histogram::max_significant_digits)
+                  return ParserResult::runtimeError("--histogram-digits must be in [" + std::to_string(Histogram::min_significant_digits) + ", "
+                      + std::to_string(Histogram::max_significant_digits) + "]");
+
+              latencies.significant_digits = digits;
+              return ParserResult::ok(ParseResultType::Matched);
+          }, "digits")["--histogram-digits"]("precision of latency histograms (default: 3)")
+        | Opt(trace_file_name, "file")["--trace"]("write traced phases of benchmarks in the Chrome trace format (Perfetto, chrome://tracing)")
+        | Opt(prefetch_fixtures)["--prefetch-fixtures"]("build all fixtures on background threads instead of on first use")
+        | Opt(adaptive_profile_file_name, "file")["--adaptive-profile"]("cost models of the adaptive policy - written by the [calibrate] test case (default: adaptive_profile.txt)")
+        | Opt(sweep.min_size, "size")["--sweep-min-size"]("smallest input of the [sweep] test case (default: 1024)")
+        | Opt(sweep.max_size, "size")["--sweep-max-size"]("largest input of the [sweep] test case (default: 100000000)")
+        | Opt(sweep.max_threads, "threads")["--sweep-max-threads"]("the [sweep] test case runs with 1..threads workers (default: hardware concurrency)")
+        | Opt(sweep.csv_file_name, "file")["--sweep-csv"]("write speedups of the [sweep] test case to a CSV file"));
+
+    if (int result = session.applyCommandLine(argc, argv); result != 0)
+        return result;
+
+    Benchmarking::perf_recorder().is_enabled = collect_counters;
+    Benchmarking::allocation_recorder().is_enabled = count_allocations;
+
+    if (!trace_file_name.empty())
+        Benchmarking::Tracer::enable();
+
+    try
+    {
+        Concurrency::adaptive_policy().load_profile(adaptive_profile_file_name);
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << adaptive_profile_file_name << ": " << e.what() << " - the adaptive policy is not calibrated\n";
+    }
+
+    if (prefetch_fixtures)
+        Benchmarking::fixtures().prefetch_all();
+
+    int result = session.run();
+
+    Benchmarking::fixtures().wait_for_prefetches();
+
+    if (!trace_file_name.empty())
+    {
+        Benchmarking::Tracer::disable();
+
+        std::ofstream trace_file{trace_file_name};
+        Benchmarking::Tracer::instance().write_chrome_trace(trace_file);
+    }
+
+    const auto& results = Benchmarking::recorded_results();
+
+    if (collect_counters)
+    {
+        if (!Benchmarking::perf_recorder().error.empty())
+            std::cerr << "Hardware counters are not available (" << Benchmarking::perf_recorder().error
+                      << ") - check /proc/sys/kernel/perf_event_paranoid\n";
+        else
+            Benchmarking::print_counters(std::cout, results);
+    }
+
+    if (count_allocations)
+        Benchmarking::print_allocations(std::cout, results);
+
+    if (latencies.is_enabled)
+        Benchmarking::print_latencies(std::cout, results);
+
+    if (!json_file_name.empty())
+    {
+        std::ofstream json_file{json_file_name};
+        Benchmarking::write_json(json_file, results);
+    }
+
+    if (!csv_file_name.empty())
+    {
+        std::ofstream csv_file{csv_file_name};
+        Benchmarking::write_csv(csv_file, results);
+    }
+
+    if (!baseline_file_name.empty())
+    {
+        std::ifstream baseline_file{baseline_file_name};
+
+        if (!baseline_file)
+        {
+            std::cerr << "Cannot open baseline: " << baseline_file_name << "\n";
+            return 1;
+        }
+
+        const auto comparisons = Benchmarking::compare_with_baseline(Benchmarking::read_json(baseline_file), results, regression_threshold, significance_level);
+        Benchmarking::print_comparisons(std::cout, comparisons);
+
+        const auto no_of_regressions = std::count_if(comparisons.begin(), comparisons.end(), [](const auto& c) { return c.is_regression; });
+        std::cout << no_of_regressions << " regression(s) found\n";
+
+        if (no_of_regressions > 0 && result == 0)
+            result = 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,275 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_HAS_PERF_EVENT 1
+#endif
+
+namespace Benchmarking
+{
+    enum class PerfEvent
+    {
+        cycles,
+        instructions,
+        cache_misses,
+        branch_misses,
+        llc_loads
+    };
+
+    inline constexpr size_t no_of_perf_events = 5;
+
+    inline constexpr std::array<const char*, no_of_perf_events> perf_event_names = {"cycles", "instructions", "cache_misses", "branch_misses", "llc_loads"};
+
+    // totals of hardware events - nullopt when an event is not supported by the CPU, the kernel or the sandbox
+    struct PerfCounts
+    {
+        std::array<std::optional<double>, no_of_perf_events> values;
+
+        std::optional<double> operator[](PerfEvent event) const
+        {
+            return values[static_cast<size_t>(event)];
+        }
+
+        bool empty() const
+        {
+            for (const auto& value : values)
+                if (value)
+                    return false;
+            return true;
+        }
+
+        PerfCounts& operator+=(const PerfCounts& other)
+        {
+            for (size_t i = 0; i < no_of_perf_events; ++i)
+                if (other.values[i])
+                    values[i] = values[i].value_or(0.0) + *other.values[i];
+
+            return *this;
+        }
+    };
+
+    // counters of one benchmark accumulated over all of its runs
+    struct PerfSample
+    {
+        PerfCounts counts;
+        uint64_t runs = 0;
+        size_t no_of_elements = 0;
+
+        std::optional<double> per_run(PerfEvent event) const
+        {
+            if (auto count = counts[event]; count && runs > 0)
+                return *count / static_cast<double>(runs);
+            return std::nullopt;
+        }
+
+        std::optional<double> per_element(PerfEvent event) const
+        {
+            if (auto count = per_run(event); count && no_of_elements > 0)
+                return *count / static_cast<double>(no_of_elements);
+            return std::nullopt;
+        }
+
+        std::optional<double> instructions_per_cycle() const
+        {
+            auto cycles = counts[PerfEvent::cycles];
+            auto instructions = counts[PerfEvent::instructions];
+
+            if (cycles && instructions && *cycles > 0.0)
+                return *instructions / *cycles;
+            return std::nullopt;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // perf_event_open counters of every thread of the process
+
+    class PerfCounters
+    {
+        struct Counter
+        {
+            int fd;
+            PerfEvent event;
+        };
+
+        std::vector<Counter> counters_;
+        std::string error_;
+
+#ifdef PERF_COUNTERS_HAS_PERF_EVENT
+        static perf_event_attr event_attributes(PerfEvent event)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1; // allowed with the default perf_event_paranoid = 2
+            attr.exclude_hv = 1;
+            attr.inherit = 1;        // threads started while counting are included
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            switch (event)
+            {
+            case PerfEvent::cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case PerfEvent::instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case PerfEvent::cache_misses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case PerfEvent::branch_misses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case PerfEvent::llc_loads:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16);
+                break;
+            }
+
+            return attr;
+        }
+
+        static std::vector<pid_t> thread_ids()
+        {
+            std::vector<pid_t> ids;
+
+            if (DIR* tasks = ::opendir("/proc/self/task"))
+            {
+                while (dirent* entry = ::readdir(tasks))
+                    if (entry->d_name[0] != '.')
+                        ids.push_back(static_cast<pid_t>(std::stol(entry->d_name)));
+                ::closedir(tasks);
+            }
+
+            if (ids.empty())
+                ids.push_back(0); // calling thread only
+
+            return ids;
+        }
+#endif
+
+    public:
+        // threads of the pools are already running, so each of them gets its own set of counters
+        PerfCounters()
+        {
+#ifdef PERF_COUNTERS_HAS_PERF_EVENT
+            for (pid_t thread_id : thread_ids())
+            {
+                for (size_t i = 0; i < no_of_perf_events; ++i)
+                {
+                    auto event = static_cast<PerfEvent>(i);
+                    auto attr = event_attributes(event);
+
+                    int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, thread_id, -1, -1, 0));
+                    if (fd == -1)
+                    {
+                        if (error_.empty())
+                            error_ = std::string(perf_event_names[i]) + ": " + std::strerror(errno);
+                        continue;
+                    }
+
+                    counters_.push_back({fd, event});
+                }
+            }
+#else
+            error_ = "perf_event_open is available only on Linux";
+#endif
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        ~PerfCounters()
+        {
+#ifdef PERF_COUNTERS_HAS_PERF_EVENT
+            for (const auto& counter : counters_)
+                ::close(counter.fd);
+#endif
+        }
+
+        bool is_available() const
+        {
+            return !counters_.empty();
+        }
+
+        // first reason why a counter could not be opened
+        const std::string& error() const
+        {
+            return error_;
+        }
+
+        void start()
+        {
+#ifdef PERF_COUNTERS_HAS_PERF_EVENT
+            for (const auto& counter : counters_)
+                ::ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            for (const auto& counter : counters_)
+                ::ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+
+        PerfCounts stop()
+        {
+            PerfCounts counts;
+
+#ifdef PERF_COUNTERS_HAS_PERF_EVENT
+            for (const auto& counter : counters_)
+                ::ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            for (const auto& counter : counters_)
+            {
+                uint64_t values[3]; // value, time enabled, time running
+                if (::read(counter.fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)))
+                    continue;
+
+                // scaled when the PMU was multiplexed between more events than it has counters
+                double value = static_cast<double>(values[0]);
+                if (values[2] > 0 && values[2] < values[1])
+                    value *= static_cast<double>(values[1]) / static_cast<double>(values[2]);
+
+                auto& total = counts.values[static_cast<size_t>(counter.event)];
+                total = total.value_or(0.0) + value;
+            }
+#endif
+
+            return counts;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // collecting counters of Catch benchmarks
+
+    struct PerfRecorder
+    {
+        bool is_enabled = false;            // set by --perf-counters
+        std::optional<PerfSample> current;  // reset by the results listener when a benchmark starts
+        std::string error;                  // why counters are not available
+    };
+
+    inline PerfRecorder& perf_recorder()
+    {
+        static PerfRecorder recorder;
+        return recorder;
+    }
+}
+
+#endif
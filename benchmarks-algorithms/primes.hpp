@@ -0,0 +1,510 @@
+#ifndef PRIMES_HPP
+#define PRIMES_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <execution>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Primes
+{
+    constexpr uint64_t isqrt(uint64_t n)
+    {
+        if (n < 2)
+            return n;
+
+        // Newton iteration from an overestimate - no floating point rounding issues near 2^64
+        uint64_t x = n;
+        uint64_t y = x / 2 + x % 2;
+        while (y < x)
+        {
+            x = y;
+            y = (x + n / x) / 2;
+        }
+
+        return x;
+    }
+
+    // odd primes <= limit - simple sieve of Eratosthenes, used for base primes of a segmented sieve
+    inline std::vector<uint64_t> odd_primes_up_to(uint64_t limit)
+    {
+        std::vector<uint64_t> primes;
+
+        if (limit < 3)
+            return primes;
+
+        std::vector<bool> is_composite((limit - 1) / 2); // index i <-> 2 * i + 3
+
+        for (uint64_t i = 0; i < is_composite.size(); ++i)
+        {
+            if (is_composite[i])
+                continue;
+
+            const uint64_t p = 2 * i + 3;
+            primes.push_back(p);
+
+            for (uint64_t m = p * p; m <= limit; m += 2 * p)
+                is_composite[(m - 3) / 2] = true;
+        }
+
+        return primes;
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // deterministic Miller-Rabin for the whole uint64_t range
+
+    namespace Details
+    {
+        struct U128
+        {
+            uint64_t low;
+            uint64_t high;
+        };
+
+        inline U128 mul_wide(uint64_t a, uint64_t b)
+        {
+#ifdef __SIZEOF_INT128__
+            const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            return {static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64)};
+#else
+            const uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+            const uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+
+            const uint64_t lo_lo = a_lo * b_lo;
+            const uint64_t hi_lo = a_hi * b_lo;
+            const uint64_t lo_hi = a_lo * b_hi;
+            const uint64_t hi_hi = a_hi * b_hi;
+
+            const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+
+            return {(cross << 32) | (lo_lo & 0xFFFFFFFF), (hi_lo >> 32) + (cross >> 32) + hi_hi};
+#endif
+        }
+
+        // arithmetic modulo an odd n in Montgomery form with R = 2^64
+        class Montgomery
+        {
+            uint64_t n_;
+            uint64_t n_inv_; // n * n_inv_ == 1 (mod 2^64)
+            uint64_t r2_;    // R^2 mod n
+
+#ifndef __SIZEOF_INT128__
+            static uint64_t mod_of_shifted(uint64_t a, uint64_t n) // (a * 2^64) mod n, a < n
+            {
+                for (int i = 0; i < 64; ++i)
+                {
+                    const bool carry = a >> 63;
+                    a <<= 1;
+                    if (carry || a >= n)
+                        a -= n;
+                }
+
+                return a;
+            }
+#endif
+
+        public:
+            explicit Montgomery(uint64_t n)
+                : n_{n}
+                , n_inv_{n}
+            {
+                for (int i = 0; i < 5; ++i) // Newton iteration - every step doubles the number of correct bits
+                    n_inv_ *= 2 - n * n_inv_;
+
+#ifdef __SIZEOF_INT128__
+                const unsigned __int128 r = (0 - n) % n;
+                r2_ = static_cast<uint64_t>(r * r % n);
+#else
+                r2_ = mod_of_shifted(mod_of_shifted(1 % n, n), n);
+#endif
+            }
+
+            // T * R^-1 mod n; low words of T and m * n are equal, so only the high words are subtracted
+            uint64_t reduce(U128 t) const
+            {
+                const uint64_t m = t.low * n_inv_;
+                const uint64_t mn_high = mul_wide(m, n_).high;
+
+                return t.high >= mn_high ? t.high - mn_high : t.high + (n_ - mn_high);
+            }
+
+            uint64_t multiply(uint64_t a, uint64_t b) const
+            {
+                return reduce(mul_wide(a, b));
+            }
+
+            uint64_t to_montgomery(uint64_t a) const
+            {
+                return multiply(a % n_, r2_);
+            }
+
+            uint64_t one() const
+            {
+                return (0 - n_) % n_; // R mod n
+            }
+
+            uint64_t power(uint64_t base, uint64_t exponent) const
+            {
+                uint64_t result = one();
+
+                for (; exponent > 0; exponent >>= 1)
+                {
+                    if (exponent & 1)
+                        result = multiply(result, base);
+                    base = multiply(base, base);
+                }
+
+                return result;
+            }
+        };
+
+        // n < 2^32 - products fit in 64 bits, no Montgomery form needed
+        inline bool is_strong_probable_prime_32(uint64_t n, uint64_t witness, uint64_t d, int s)
+        {
+            uint64_t x = 1;
+            for (uint64_t base = witness % n, exponent = d; exponent > 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                    x = x * base % n;
+                base = base * base % n;
+            }
+
+            if (x == 1 || x == n - 1)
+                return true;
+
+            for (int r = 1; r < s; ++r)
+            {
+                x = x * x % n;
+                if (x == n - 1)
+                    return true;
+            }
+
+            return false;
+        }
+    }
+
+    inline bool is_prime_miller_rabin(uint64_t number)
+    {
+        constexpr std::array<uint64_t, 11> small_primes = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31};
+
+        if (number < 2)
+            return false;
+
+        for (uint64_t p : small_primes)
+        {
+            if (number % p == 0)
+                return number == p;
+        }
+
+        if (number < 37 * 37)
+            return true;
+
+        uint64_t d = number - 1;
+        int s = 0;
+        while (d % 2 == 0)
+        {
+            d /= 2;
+            ++s;
+        }
+
+        if (number < (uint64_t{1} << 32))
+        {
+            // Jaeschke - bases 2, 7, 61 are deterministic for every n < 4 759 123 141
+            return Details::is_strong_probable_prime_32(number, 2, d, s)
+                && Details::is_strong_probable_prime_32(number, 7, d, s)
+                && Details::is_strong_probable_prime_32(number, 61, d, s);
+        }
+
+        // Sinclair's bases - deterministic for every n < 2^64
+        constexpr std::array<uint64_t, 7> witnesses = {2, 325, 9'375, 28'178, 450'775, 9'780'504, 1'795'265'022};
+
+        const Details::Montgomery mont{number};
+        const uint64_t one = mont.one();
+        const uint64_t minus_one = number - one; // -R mod n
+
+        for (uint64_t witness : witnesses)
+        {
+            if (witness % number == 0)
+                continue;
+
+            uint64_t x = mont.power(mont.to_montgomery(witness), d);
+
+            if (x == one || x == minus_one)
+                continue;
+
+            bool is_witness_of_compositeness = true;
+            for (int r = 1; r < s; ++r)
+            {
+                x = mont.multiply(x, x);
+
+                if (x == minus_one)
+                {
+                    is_witness_of_compositeness = false;
+                    break;
+                }
+            }
+
+            if (is_witness_of_compositeness)
+                return false;
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // compile-time prime table - odd numbers only, one bit each: bit i <-> 2 * i + 1
+
+    template <uint64_t Limit>
+    constexpr auto create_prime_bitmap()
+    {
+        static_assert(Limit >= 2);
+
+        constexpr uint64_t no_of_odds = (Limit + 1) / 2;
+        constexpr uint64_t block_size = 1 << 16; // loops are split into blocks - compilers cap iterations of a single constexpr loop
+
+        constexpr size_t no_of_words = (no_of_odds + 63) / 64;
+
+        // sieving works on a plain array - element access through std::array::operator[] costs extra constexpr operations
+        uint64_t words[no_of_words] = {};
+
+        for (size_t i = 0; i < no_of_words; ++i)
+            words[i] = ~uint64_t{0};
+
+        words[0] &= ~uint64_t{1}; // 1 is not a prime
+
+        // index space: odd multiples m, m + 2p, ... of p are indexes m / 2, m / 2 + p, ...
+        for (uint64_t p = 3; p * p <= Limit; p += 2)
+        {
+            if (!((words[p / 2 / 64] >> (p / 2 % 64)) & 1))
+                continue;
+
+            for (uint64_t block_start = p * p / 2; block_start < no_of_odds; block_start += p * block_size)
+            {
+                const uint64_t block_end = block_start + p * block_size < no_of_odds ? block_start + p * block_size : no_of_odds;
+
+                for (uint64_t index = block_start; index < block_end; index += p)
+                    words[index >> 6] &= ~(uint64_t{1} << (index & 63));
+            }
+        }
+
+        std::array<uint64_t, no_of_words> bitmap{};
+        for (size_t i = 0; i < no_of_words; ++i)
+            bitmap[i] = words[i];
+
+        return bitmap;
+    }
+
+    template <size_t N>
+    constexpr bool is_prime_in_bitmap(const std::array<uint64_t, N>& bitmap, uint64_t number)
+    {
+        if (number % 2 == 0)
+            return number == 2;
+
+        return (bitmap[number / 2 / 64] >> (number / 2 % 64)) & 1;
+    }
+
+    constexpr uint64_t small_primes_limit = uint64_t{1} << 20;
+
+    inline constexpr auto small_primes_bitmap = create_prime_bitmap<small_primes_limit>();
+
+    // O(1) bit test up to small_primes_limit, Miller-Rabin above it
+    inline bool is_prime(uint64_t number)
+    {
+        if (number <= small_primes_limit)
+            return is_prime_in_bitmap(small_primes_bitmap, number);
+
+        return is_prime_miller_rabin(number);
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // segmented sieve of Eratosthenes answering batch primality queries
+    // - dense queries: the range [min, max] is sieved once into a single table
+    // - sparse queries: queries are sorted and grouped by segment; segments without queries are never sieved
+    // - a segment holds segment_size odd numbers, one byte each, so it stays in L1/L2 cache
+    // - numbers above max_sieved_value are tested with Miller-Rabin - base primes up to sqrt(2^64) would take gigabytes
+
+    class SegmentedSieve
+    {
+        size_t segment_size_;
+
+        // a table of odd numbers this many times larger than the number of queries is still cheaper than sorting them
+        static constexpr uint64_t dense_range_factor = 16;
+
+        // clears flags of odd composites in [segment_low + 1, segment_last]; odd number segment_low + 1 + 2 * i <-> is_prime_odd[i]
+        static void sieve_segment(const std::vector<uint64_t>& base_primes, uint64_t segment_low, uint64_t segment_last, uint8_t* is_prime_odd)
+        {
+            for (uint64_t p : base_primes)
+            {
+                if (p * p > segment_last)
+                    break;
+
+                uint64_t start = std::max(p * p, (segment_low + p) / p * p);
+                if (start % 2 == 0)
+                    start += p;
+
+                for (uint64_t m = start; m <= segment_last; m += 2 * p)
+                {
+                    is_prime_odd[(m - segment_low - 1) / 2] = 0;
+
+                    if (segment_last - m < 2 * p)
+                        break;
+                }
+            }
+        }
+
+    public:
+        static constexpr size_t default_segment_size = 32 * 1024;
+
+        // base primes up to 2^20 - the same limit as the bitmap of small primes, 82K primes in 0.6 MB
+        static constexpr uint64_t max_sieved_value = small_primes_limit * small_primes_limit;
+
+        explicit SegmentedSieve(size_t segment_size = default_segment_size)
+            : segment_size_{std::max<size_t>(segment_size, 1)}
+        {
+        }
+
+        size_t segment_size() const
+        {
+            return segment_size_;
+        }
+
+        std::vector<uint8_t> are_primes(const std::vector<uint64_t>& numbers) const
+        {
+            return are_primes(std::execution::seq, numbers);
+        }
+
+        template <typename ExecutionPolicy,
+            typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+        std::vector<uint8_t> are_primes(ExecutionPolicy&& policy, const std::vector<uint64_t>& numbers) const
+        {
+            std::vector<uint8_t> results(numbers.size(), 0);
+
+            using Query = std::pair<uint64_t, size_t>; // value, index in numbers
+            std::vector<Query> queries;
+            queries.reserve(numbers.size());
+            std::vector<size_t> large_numbers; // indices in numbers
+
+            for (size_t i = 0; i < numbers.size(); ++i)
+            {
+                const uint64_t n = numbers[i];
+
+                if (n == 2)
+                    results[i] = 1;
+                else if (n > max_sieved_value && n % 2 == 1)
+                    large_numbers.push_back(i);
+                else if (n >= 3 && n % 2 == 1)
+                    queries.emplace_back(n, i);
+            }
+
+            std::for_each(policy, large_numbers.begin(), large_numbers.end(), [&](size_t i) {
+                results[i] = is_prime_miller_rabin(numbers[i]);
+            });
+
+            if (queries.empty())
+                return results;
+
+            const auto [min_query, max_query] = std::minmax_element(queries.begin(), queries.end());
+            const uint64_t min_value = min_query->first;
+            const uint64_t max_value = max_query->first;
+            const auto base_primes = odd_primes_up_to(isqrt(max_value));
+            const uint64_t segment_span = 2 * static_cast<uint64_t>(segment_size_);
+
+            // dense queries - the whole range [min, max] is sieved once, segment by segment, into one table
+            if ((max_value - min_value) / 2 <= std::max<uint64_t>(dense_range_factor * queries.size(), segment_size_))
+            {
+                const uint64_t range_low = min_value - 1; // even
+                const size_t no_of_odds = static_cast<size_t>((max_value - range_low + 1) / 2);
+
+                std::vector<uint8_t> is_prime_odd(no_of_odds, 1);
+
+                std::vector<uint64_t> segment_lows((no_of_odds + segment_size_ - 1) / segment_size_);
+                for (size_t i = 0; i < segment_lows.size(); ++i)
+                    segment_lows[i] = range_low + i * segment_span;
+
+                std::for_each(policy, segment_lows.begin(), segment_lows.end(), [&](uint64_t segment_low) {
+                    const uint64_t segment_last = std::min(segment_low + segment_span - 1, max_value);
+                    sieve_segment(base_primes, segment_low, segment_last, is_prime_odd.data() + (segment_low - range_low) / 2);
+                });
+
+                std::for_each(policy, queries.begin(), queries.end(), [&](const Query& query) {
+                    results[query.second] = is_prime_odd[(query.first - range_low - 1) / 2];
+                });
+
+                return results;
+            }
+
+            // sparse queries - only segments that contain a query are sieved
+            std::sort(policy, queries.begin(), queries.end());
+
+            using QueryRange = std::pair<size_t, size_t>;
+            std::vector<QueryRange> segments;
+            for (size_t first = 0; first < queries.size();)
+            {
+                const uint64_t segment_id = queries[first].first / segment_span;
+
+                size_t last = first + 1;
+                while (last < queries.size() && queries[last].first / segment_span == segment_id)
+                    ++last;
+
+                segments.emplace_back(first, last);
+                first = last;
+            }
+
+            std::for_each(policy, segments.begin(), segments.end(), [&](const QueryRange& segment) {
+                thread_local std::vector<uint8_t> is_prime_odd;
+                is_prime_odd.assign(segment_size_, 1);
+
+                const uint64_t segment_low = queries[segment.first].first / segment_span * segment_span;
+                sieve_segment(base_primes, segment_low, segment_low + segment_span - 1, is_prime_odd.data());
+
+                for (size_t q = segment.first; q < segment.second; ++q)
+                {
+                    const auto [value, index] = queries[q];
+                    results[index] = is_prime_odd[(value - segment_low - 1) / 2];
+                }
+            });
+
+            return results;
+        }
+
+        // partition with primes first - flags are computed in one batch and permuted together with the items
+        template <typename ExecutionPolicy, typename RandomIt,
+            typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+        RandomIt partition(ExecutionPolicy&& policy, RandomIt first, RandomIt last) const
+        {
+            auto flags = are_primes(policy, std::vector<uint64_t>(first, last));
+
+            size_t i = 0;
+            size_t j = flags.size();
+
+            while (true)
+            {
+                while (i < j && flags[i])
+                    ++i;
+                while (i < j && !flags[j - 1])
+                    --j;
+
+                if (i >= j)
+                    break;
+
+                std::iter_swap(first + i, first + (j - 1));
+                std::swap(flags[i], flags[j - 1]);
+                ++i;
+                --j;
+            }
+
+            return first + i;
+        }
+
+        template <typename RandomIt>
+        RandomIt partition(RandomIt first, RandomIt last) const
+        {
+            return partition(std::execution::seq, first, last);
+        }
+    };
+}
+
+#endif
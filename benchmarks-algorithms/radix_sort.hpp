@@ -0,0 +1,300 @@
+#ifndef RADIX_SORT_HPP
+#define RADIX_SORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <execution>
+#include <iterator>
+#include <numeric>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Algorithms
+{
+    ///////////////////////////////////////////////////////////////
+    // byte maps - every byte of a key is translated before it is used as a digit
+
+    using ByteMap = std::array<unsigned char, 256>;
+
+    constexpr ByteMap identity_byte_map()
+    {
+        ByteMap map{};
+
+        for (size_t i = 0; i < map.size(); ++i)
+            map[i] = static_cast<unsigned char>(i);
+
+        return map;
+    }
+
+    constexpr ByteMap ascii_lower_byte_map()
+    {
+        ByteMap map = identity_byte_map();
+
+        for (size_t c = 'A'; c <= 'Z'; ++c)
+            map[c] = static_cast<unsigned char>(c - 'A' + 'a');
+
+        return map;
+    }
+
+    inline constexpr ByteMap identity_bytes = identity_byte_map();
+    inline constexpr ByteMap ascii_lower_bytes = ascii_lower_byte_map();
+
+    namespace Details
+    {
+        struct RadixEntry
+        {
+            const char* data;
+            size_t size;
+            size_t index;
+        };
+
+        constexpr size_t no_of_buckets = 257; // bucket 0 - end of string
+        constexpr size_t multikey_quicksort_threshold = 64;
+        constexpr size_t insertion_sort_threshold = 12;
+        constexpr size_t parallel_threshold = 1 << 14;
+
+        inline size_t digit_at(const RadixEntry& entry, size_t depth, const ByteMap& byte_map)
+        {
+            return depth < entry.size ? byte_map[static_cast<unsigned char>(entry.data[depth])] + 1u : 0u;
+        }
+
+        inline bool less_from(const RadixEntry& a, const RadixEntry& b, size_t depth, const ByteMap& byte_map)
+        {
+            const size_t common_size = std::min(a.size, b.size);
+
+            for (size_t i = depth; i < common_size; ++i)
+            {
+                const auto ca = byte_map[static_cast<unsigned char>(a.data[i])];
+                const auto cb = byte_map[static_cast<unsigned char>(b.data[i])];
+
+                if (ca != cb)
+                    return ca < cb;
+            }
+
+            return a.size < b.size;
+        }
+
+        inline void insertion_sort(RadixEntry* entries, size_t n, size_t depth, const ByteMap& byte_map)
+        {
+            for (size_t i = 1; i < n; ++i)
+            {
+                RadixEntry entry = entries[i];
+                size_t j = i;
+
+                for (; j > 0 && less_from(entry, entries[j - 1], depth, byte_map); --j)
+                    entries[j] = entries[j - 1];
+
+                entries[j] = entry;
+            }
+        }
+
+        // Bentley & Sedgewick - three-way partitioning on a single digit
+        inline void multikey_quicksort(RadixEntry* entries, size_t n, size_t depth, const ByteMap& byte_map)
+        {
+            while (n > insertion_sort_threshold)
+            {
+                const size_t a = digit_at(entries[0], depth, byte_map);
+                const size_t b = digit_at(entries[n / 2], depth, byte_map);
+                const size_t c = digit_at(entries[n - 1], depth, byte_map);
+                const size_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+                size_t lt = 0, i = 0, gt = n;
+                while (i < gt)
+                {
+                    const size_t digit = digit_at(entries[i], depth, byte_map);
+
+                    if (digit < pivot)
+                        std::swap(entries[lt++], entries[i++]);
+                    else if (digit > pivot)
+                        std::swap(entries[i], entries[--gt]);
+                    else
+                        ++i;
+                }
+
+                multikey_quicksort(entries, lt, depth, byte_map);
+                multikey_quicksort(entries + gt, n - gt, depth, byte_map);
+
+                if (pivot == 0) // all strings in the middle part have ended
+                    return;
+
+                entries += lt;
+                n = gt - lt;
+                ++depth;
+            }
+
+            insertion_sort(entries, n, depth, byte_map);
+        }
+
+        inline void msd_radix_sort(RadixEntry* entries, RadixEntry* buffer, size_t n, size_t depth, const ByteMap& byte_map)
+        {
+            if (n < multikey_quicksort_threshold)
+            {
+                multikey_quicksort(entries, n, depth, byte_map);
+                return;
+            }
+
+            std::array<size_t, no_of_buckets> bucket_starts{};
+
+            // shared prefix - skip digits on which all strings agree without moving anything
+            for (;; ++depth)
+            {
+                bucket_starts.fill(0);
+                for (size_t i = 0; i < n; ++i)
+                    ++bucket_starts[digit_at(entries[i], depth, byte_map)];
+
+                if (bucket_starts[0] == n)
+                    return;
+
+                if (std::find(bucket_starts.begin(), bucket_starts.end(), n) == bucket_starts.end())
+                    break;
+            }
+
+            std::exclusive_scan(bucket_starts.begin(), bucket_starts.end(), bucket_starts.begin(), size_t{0});
+
+            auto positions = bucket_starts;
+            for (size_t i = 0; i < n; ++i)
+                buffer[positions[digit_at(entries[i], depth, byte_map)]++] = entries[i];
+
+            std::copy(buffer, buffer + n, entries);
+
+            for (size_t bucket = 1; bucket < no_of_buckets; ++bucket)
+            {
+                const size_t bucket_size = (bucket + 1 < no_of_buckets ? bucket_starts[bucket + 1] : n) - bucket_starts[bucket];
+
+                if (bucket_size > 1)
+                    msd_radix_sort(entries + bucket_starts[bucket], buffer + bucket_starts[bucket], bucket_size, depth + 1, byte_map);
+            }
+        }
+
+        // first pass: per-chunk histograms and scatter run in parallel, then every bucket is sorted as a separate task
+        inline void parallel_msd_radix_sort(RadixEntry* entries, RadixEntry* buffer, size_t n, const ByteMap& byte_map)
+        {
+            const size_t no_of_chunks = std::max(1u, std::thread::hardware_concurrency());
+            const size_t chunk_size = n / no_of_chunks + 1;
+
+            using Histogram = std::array<size_t, no_of_buckets>;
+            std::vector<Histogram> histograms(no_of_chunks);
+            std::vector<size_t> chunks(no_of_chunks);
+            std::iota(chunks.begin(), chunks.end(), size_t{0});
+
+            auto chunk_range = [&](size_t chunk) { return std::pair{std::min(chunk * chunk_size, n), std::min((chunk + 1) * chunk_size, n)}; };
+
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+                auto [begin, end] = chunk_range(chunk);
+                Histogram& histogram = histograms[chunk];
+                histogram.fill(0);
+                for (size_t i = begin; i < end; ++i)
+                    ++histogram[digit_at(entries[i], 0, byte_map)];
+            });
+
+            // chunk offsets: bucket-major, chunk-minor - keeps the scatter stable
+            Histogram bucket_starts{};
+            size_t offset = 0;
+            for (size_t bucket = 0; bucket < no_of_buckets; ++bucket)
+            {
+                bucket_starts[bucket] = offset;
+                for (auto& histogram : histograms)
+                {
+                    const size_t count = histogram[bucket];
+                    histogram[bucket] = offset;
+                    offset += count;
+                }
+            }
+
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+                auto [begin, end] = chunk_range(chunk);
+                Histogram& positions = histograms[chunk];
+                for (size_t i = begin; i < end; ++i)
+                    buffer[positions[digit_at(entries[i], 0, byte_map)]++] = entries[i];
+            });
+
+            std::copy(std::execution::par, buffer, buffer + n, entries);
+
+            std::vector<size_t> buckets(no_of_buckets - 1);
+            std::iota(buckets.begin(), buckets.end(), size_t{1});
+
+            std::for_each(std::execution::par, buckets.begin(), buckets.end(), [&](size_t bucket) {
+                const size_t bucket_size = (bucket + 1 < no_of_buckets ? bucket_starts[bucket + 1] : n) - bucket_starts[bucket];
+
+                if (bucket_size > 1)
+                    msd_radix_sort(entries + bucket_starts[bucket], buffer + bucket_starts[bucket], bucket_size, 1, byte_map);
+            });
+        }
+
+        template <typename ExecutionPolicy, typename RandomIt>
+        void radix_sort_impl(ExecutionPolicy&& policy, RandomIt first, RandomIt last, const ByteMap& byte_map, bool is_parallel)
+        {
+            using Item = typename std::iterator_traits<RandomIt>::value_type;
+
+            const auto n = static_cast<size_t>(std::distance(first, last));
+
+            if (n < 2)
+                return;
+
+            std::vector<RadixEntry> entries(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const std::string_view item = first[i];
+                entries[i] = RadixEntry{item.data(), item.size(), i};
+            }
+
+            std::vector<RadixEntry> buffer(n);
+
+            if (is_parallel && n >= parallel_threshold)
+                parallel_msd_radix_sort(entries.data(), buffer.data(), n, byte_map);
+            else
+                msd_radix_sort(entries.data(), buffer.data(), n, 0, byte_map);
+
+            // the item of position i comes from position entries[i].index - the permutation is applied in place, cycle by cycle
+            // (entries point into the items, so the indexes are taken out before anything is moved)
+            std::vector<size_t> indexes(n);
+            std::transform(policy, entries.begin(), entries.end(), indexes.begin(), [](const RadixEntry& entry) { return entry.index; });
+
+            for (size_t start = 0; start < n; ++start)
+            {
+                if (indexes[start] == start)
+                    continue;
+
+                Item item = std::move(first[start]);
+
+                size_t position = start;
+                while (indexes[position] != start)
+                {
+                    const size_t source = indexes[position];
+                    first[position] = std::move(first[source]);
+                    indexes[position] = position;
+                    position = source;
+                }
+
+                first[position] = std::move(item);
+                indexes[position] = position;
+            }
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////
+    // MSD radix sort for ranges of strings (anything convertible to std::string_view)
+    // bytes are compared after translation by byte_map, e.g. ascii_lower_bytes for case-insensitive order
+
+    template <typename ExecutionPolicy, typename RandomIt,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void radix_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last, const ByteMap& byte_map = identity_bytes)
+    {
+        constexpr bool is_parallel = !std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>;
+
+        Details::radix_sort_impl(policy, first, last, byte_map, is_parallel);
+    }
+
+    template <typename RandomIt,
+        typename = std::enable_if_t<!std::is_execution_policy_v<std::decay_t<RandomIt>>>>
+    void radix_sort(RandomIt first, RandomIt last, const ByteMap& byte_map = identity_bytes)
+    {
+        radix_sort(std::execution::seq, first, last, byte_map);
+    }
+}
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef SCALING_SWEEP_HPP
+#define SCALING_SWEEP_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+#if __has_include(<tbb/global_control.h>)
+#include <tbb/global_control.h>
+#define SCALING_SWEEP_HAS_TBB 1
+#endif
+
+namespace Benchmarking
+{
+    ///////////////////////////////////////////////////////////////
+    // speedup of parallel algorithms over a grid of input sizes and worker counts
+
+    struct SweepConfig
+    {
+        size_t min_size = 1 << 10;
+        size_t max_size = 100'000'000;
+        size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t min_repetitions = 3;
+        std::chrono::nanoseconds min_time_per_point = std::chrono::milliseconds(20);
+        std::string csv_file_name;
+
+        // powers of two in [min_size, max_size]
+        std::vector<size_t> sizes() const
+        {
+            std::vector<size_t> sizes;
+
+            size_t size = 1;
+            while (size < min_size)
+                size *= 2;
+
+            for (; size <= max_size; size *= 2)
+                sizes.push_back(size);
+
+            return sizes;
+        }
+
+        std::vector<size_t> thread_counts() const
+        {
+            std::vector<size_t> counts(std::max<size_t>(max_threads, 1));
+            std::iota(counts.begin(), counts.end(), 1);
+            return counts;
+        }
+    };
+
+    // set from the command line
+    inline SweepConfig& sweep_config()
+    {
+        static SweepConfig config;
+        return config;
+    }
+
+    struct SweepPoint
+    {
+        size_t size;
+        size_t no_of_threads;
+        double sequential_ns;
+        double parallel_ns;
+
+        double speedup() const
+        {
+            return sequential_ns / parallel_ns;
+        }
+
+        double efficiency() const
+        {
+            return speedup() / static_cast<double>(no_of_threads);
+        }
+    };
+
+    struct SweepResult
+    {
+        std::string name;
+        std::vector<SweepPoint> points;
+
+        // smallest size from which the parallel version stays faster than the sequential one
+        std::optional<size_t> break_even_size(size_t no_of_threads) const
+        {
+            std::optional<size_t> size;
+
+            for (const auto& point : points)
+            {
+                if (point.no_of_threads != no_of_threads)
+                    continue;
+
+                if (point.speedup() <= 1.0)
+                    size.reset();
+                else if (!size)
+                    size = point.size;
+            }
+
+            return size;
+        }
+    };
+
+    namespace Details
+    {
+        inline void escape([[maybe_unused]] void* p)
+        {
+#if defined(__GNUC__)
+            asm volatile("" : : "g"(p) : "memory");
+#else
+            static void* volatile sink;
+            sink = p;
+#endif
+        }
+
+        // median time of runs on fresh copies of the input - copying is not measured
+        template <typename Input, typename Run>
+        double median_time_ns(const SweepConfig& config, const Input& input, Run&& run)
+        {
+            std::vector<double> times;
+            std::chrono::nanoseconds total{0};
+
+            while (times.size() < config.min_repetitions || total < config.min_time_per_point)
+            {
+                Input work = input;
+                escape(&work);
+
+                const auto start = std::chrono::steady_clock::now();
+                run(work);
+                const auto elapsed = std::chrono::steady_clock::now() - start;
+
+                escape(&work);
+
+                total += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+                times.push_back(std::chrono::duration<double, std::nano>(elapsed).count());
+            }
+
+            const auto middle = times.begin() + times.size() / 2;
+            std::nth_element(times.begin(), middle, times.end());
+
+            return *middle;
+        }
+    }
+
+    // make_input(size) creates the input, sequential(input&) is the baseline, parallel(input&, pool) runs with
+    // n workers: std::execution algorithms are limited with tbb::global_control, thread pool algorithms get a pool of n threads
+    template <typename MakeInput, typename Sequential, typename Parallel>
+    SweepResult run_sweep(std::string name, const SweepConfig& config, MakeInput make_input, Sequential sequential, Parallel parallel)
+    {
+        SweepResult result{std::move(name), {}};
+
+        for (size_t size : config.sizes())
+        {
+            const auto input = make_input(size);
+            const double sequential_ns = Details::median_time_ns(config, input, [&](auto& work) { sequential(work); });
+
+            for (size_t no_of_threads : config.thread_counts())
+            {
+                // only the measured pool is alive - idle pools would compete for cores; its threads start before timing
+                Concurrency::ThreadPool pool{no_of_threads};
+#ifdef SCALING_SWEEP_HAS_TBB
+                tbb::global_control parallelism{tbb::global_control::max_allowed_parallelism, no_of_threads};
+#endif
+                const double parallel_ns = Details::median_time_ns(config, input, [&](auto& work) { parallel(work, pool); });
+
+                result.points.push_back({size, no_of_threads, sequential_ns, parallel_ns});
+            }
+        }
+
+        return result;
+    }
+
+    // speedup and parallel efficiency tables - rows are sizes, columns are worker counts
+    inline void print_sweep(std::ostream& out, const SweepResult& result)
+    {
+        const auto precision = out.precision();
+
+        std::vector<size_t> sizes;
+        std::vector<size_t> thread_counts;
+        for (const auto& point : result.points)
+        {
+            if (std::find(sizes.begin(), sizes.end(), point.size) == sizes.end())
+                sizes.push_back(point.size);
+            if (std::find(thread_counts.begin(), thread_counts.end(), point.no_of_threads) == thread_counts.end())
+                thread_counts.push_back(point.no_of_threads);
+        }
+
+        auto print_table = [&](const char* title, auto value) {
+            out << "\n" << result.name << " - " << title << "\n"
+                << std::setw(12) << "size" << std::setw(16) << "sequenced [us]";
+            for (size_t no_of_threads : thread_counts)
+                out << std::setw(8) << no_of_threads;
+            out << "\n";
+
+            for (size_t size : sizes)
+            {
+                bool is_first = true;
+
+                for (const auto& point : result.points)
+                {
+                    if (point.size != size)
+                        continue;
+
+                    if (is_first)
+                        out << std::setw(12) << size << std::fixed << std::setprecision(1) << std::setw(16) << point.sequential_ns / 1000.0;
+                    is_first = false;
+
+                    out << std::setprecision(2) << std::setw(8) << value(point);
+                }
+
+                out << std::defaultfloat << "\n";
+            }
+        };
+
+        print_table("speedup", [](const SweepPoint& p) { return p.speedup(); });
+        print_table("parallel efficiency", [](const SweepPoint& p) { return p.efficiency(); });
+
+        out << "break-even size:";
+        for (size_t no_of_threads : thread_counts)
+        {
+            auto size = result.break_even_size(no_of_threads);
+            out << "  " << no_of_threads << " threads - " << (size ? std::to_string(*size) : std::string("never"));
+        }
+        out << "\n";
+
+        out.precision(precision);
+    }
+
+    inline void write_sweep_csv_header(std::ostream& out)
+    {
+        out << "benchmark,size,threads,sequential_ns,parallel_ns,speedup,efficiency\n";
+    }
+
+    inline void write_sweep_csv(std::ostream& out, const SweepResult& result)
+    {
+        const auto precision = out.precision(17);
+
+        for (const auto& point : result.points)
+            out << "\"" << result.name << "\"," << point.size << "," << point.no_of_threads << "," << point.sequential_ns << ","
+                << point.parallel_ns << "," << point.speedup() << "," << point.efficiency() << "\n";
+
+        out.precision(precision);
+    }
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SORT_BY_KEY_HPP
+#define SORT_BY_KEY_HPP
+
+#include <algorithm>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Algorithms
+{
+    ///////////////////////////////////////////////////////////////
+    // decorate-sort-undecorate: key(item) is computed exactly once per item,
+    // (key, index) pairs are sorted and the range is permuted to the resulting order
+    // equal keys keep their relative order - the sort is stable
+    // items are only moved - they need not be default-constructible; keys must be default-constructible
+
+    template <typename ExecutionPolicy, typename RandomIt, typename KeyFunc, typename Compare = std::less<>,
+        typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void sort_by_key(ExecutionPolicy&& policy, RandomIt first, RandomIt last, KeyFunc key, Compare comp = {})
+    {
+        using Item = typename std::iterator_traits<RandomIt>::value_type;
+        using Key = std::decay_t<std::invoke_result_t<KeyFunc&, const Item&>>;
+        using KeyIndex = std::pair<Key, size_t>;
+
+        const auto size = static_cast<size_t>(std::distance(first, last));
+
+        std::vector<size_t> indexes(size);
+        std::iota(indexes.begin(), indexes.end(), size_t{0});
+
+        std::vector<KeyIndex> decorated(size);
+        std::transform(policy, indexes.begin(), indexes.end(), decorated.begin(),
+            [&](size_t index) { return KeyIndex{std::invoke(key, std::as_const(first[index])), index}; });
+
+        std::sort(policy, decorated.begin(), decorated.end(), [&](const KeyIndex& a, const KeyIndex& b) {
+            if (comp(a.first, b.first))
+                return true;
+            if (comp(b.first, a.first))
+                return false;
+            return a.second < b.second;
+        });
+
+        // the item of position i comes from position decorated[i].second - the permutation is applied in place, cycle by cycle
+        for (size_t i = 0; i < size; ++i)
+            indexes[i] = decorated[i].second;
+
+        for (size_t start = 0; start < size; ++start)
+        {
+            if (indexes[start] == start)
+                continue;
+
+            Item item = std::move(first[start]);
+
+            size_t position = start;
+            while (indexes[position] != start)
+            {
+                const size_t source = indexes[position];
+                first[position] = std::move(first[source]);
+                indexes[position] = position;
+                position = source;
+            }
+
+            first[position] = std::move(item);
+            indexes[position] = position;
+        }
+    }
+
+    template <typename RandomIt, typename KeyFunc, typename Compare = std::less<>,
+        typename = std::enable_if_t<!std::is_execution_policy_v<std::decay_t<RandomIt>>>>
+    void sort_by_key(RandomIt first, RandomIt last, KeyFunc key, Compare comp = {})
+    {
+        sort_by_key(std::execution::seq, first, last, std::move(key), std::move(comp));
+    }
+}
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef SPACE_SAVING_HPP
+#define SPACE_SAVING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "hashing.hpp"
+
+namespace Sketches
+{
+    ///////////////////////////////////////////////////////////////
+    // space-saving top-K (Metwally, Agrawal, El Abbadi 2005) - capacity counters for the most frequent keys
+    // - a new key takes over the smallest counter and inherits its count as the error
+    // - every key more frequent than total / capacity is monitored; count - error <= true count <= count
+    // - memory is bounded by capacity keys however large the vocabulary is
+
+    class SpaceSaving
+    {
+    public:
+        struct Counter
+        {
+            std::string key;
+            uint64_t count;
+            uint64_t error; // overestimation bound
+        };
+
+    private:
+        size_t capacity_;
+        uint64_t total_count_ = 0;
+        std::vector<Counter> counters_;                                     // reserved - slots never move, views of keys stay valid
+        std::vector<size_t> heap_;                                          // min-heap of counter indices by count
+        std::vector<size_t> heap_positions_;                                // of every counter
+        std::unordered_map<std::string_view, size_t, Hashing::WyHash> index_; // key -> counter
+
+        uint64_t count_at(size_t heap_position) const
+        {
+            return counters_[heap_[heap_position]].count;
+        }
+
+        void swap_heap(size_t a, size_t b)
+        {
+            std::swap(heap_[a], heap_[b]);
+            heap_positions_[heap_[a]] = a;
+            heap_positions_[heap_[b]] = b;
+        }
+
+        void sift_up(size_t position)
+        {
+            while (position > 0)
+            {
+                const size_t parent = (position - 1) / 2;
+                if (count_at(parent) <= count_at(position))
+                    break;
+
+                swap_heap(parent, position);
+                position = parent;
+            }
+        }
+
+        // counts only grow, so a counter moves down only
+        void sift_down(size_t position)
+        {
+            while (true)
+            {
+                const size_t left = 2 * position + 1;
+                if (left >= heap_.size())
+                    break;
+
+                const size_t right = left + 1;
+                const size_t smallest = right < heap_.size() && count_at(right) < count_at(left) ? right : left;
+                if (count_at(position) <= count_at(smallest))
+                    break;
+
+                swap_heap(position, smallest);
+                position = smallest;
+            }
+        }
+
+        void push(Counter counter)
+        {
+            const size_t index = counters_.size();
+            counters_.push_back(std::move(counter));
+            index_.emplace(counters_.back().key, index);
+
+            heap_.push_back(index);
+            heap_positions_.push_back(heap_.size() - 1);
+            sift_up(heap_.size() - 1);
+        }
+
+        void reset()
+        {
+            counters_.clear();
+            heap_.clear();
+            heap_positions_.clear();
+            index_.clear();
+            counters_.reserve(capacity_);
+        }
+
+    public:
+        explicit SpaceSaving(size_t capacity) : capacity_{capacity}
+        {
+            if (capacity == 0)
+                throw std::invalid_argument("space-saving needs capacity > 0");
+
+            counters_.reserve(capacity);
+            heap_.reserve(capacity);
+            heap_positions_.reserve(capacity);
+            index_.reserve(capacity);
+        }
+
+        // a copy rebuilds the index - views of keys refer to its own counters
+        SpaceSaving(const SpaceSaving& other) : SpaceSaving{other.capacity_}
+        {
+            for (const auto& counter : other.counters_)
+                push(counter);
+            total_count_ = other.total_count_;
+        }
+
+        SpaceSaving& operator=(const SpaceSaving& other)
+        {
+            if (this != &other)
+            {
+                SpaceSaving copy{other};
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        SpaceSaving(SpaceSaving&&) = default;            // moved vectors keep their buffers - the views stay valid
+        SpaceSaving& operator=(SpaceSaving&&) = default;
+
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        size_t size() const
+        {
+            return counters_.size();
+        }
+
+        bool is_full() const
+        {
+            return counters_.size() == capacity_;
+        }
+
+        uint64_t total_count() const
+        {
+            return total_count_;
+        }
+
+        // the smallest monitored count - an upper bound of the count of every key that is not monitored
+        uint64_t min_count() const
+        {
+            return is_full() ? count_at(0) : 0;
+        }
+
+        // approximate - keys are counted by their lengths, nodes of the index by their payload and one pointer
+        size_t memory_bytes() const
+        {
+            size_t bytes = capacity_ * (sizeof(Counter) + 2 * sizeof(size_t)) + index_.bucket_count() * sizeof(void*)
+                + index_.size() * (sizeof(std::string_view) + sizeof(size_t) + sizeof(void*));
+            for (const auto& counter : counters_)
+                bytes += counter.key.size();
+            return bytes;
+        }
+
+        void add(std::string_view key, uint64_t count = 1)
+        {
+            total_count_ += count;
+
+            if (auto it = index_.find(key); it != index_.end())
+            {
+                counters_[it->second].count += count;
+                sift_down(heap_positions_[it->second]);
+                return;
+            }
+
+            if (!is_full())
+            {
+                push({std::string{key}, count, 0});
+                return;
+            }
+
+            // the smallest counter is taken over by the new key
+            const size_t index = heap_[0];
+            auto& counter = counters_[index];
+
+            index_.erase(counter.key);
+            counter.key.assign(key.data(), key.size());
+            counter.error = counter.count;
+            counter.count += count;
+            index_.emplace(counter.key, index);
+
+            sift_down(0);
+        }
+
+        // upper bound of the count of key
+        uint64_t estimate(std::string_view key) const
+        {
+            if (auto it = index_.find(key); it != index_.end())
+                return counters_[it->second].count;
+            return min_count();
+        }
+
+        // the most frequent monitored keys first, ties in lexicographical order
+        std::vector<Counter> top(size_t k) const
+        {
+            std::vector<Counter> counters = counters_;
+            auto more_frequent = [](const Counter& a, const Counter& b) { return a.count != b.count ? a.count > b.count : a.key < b.key; };
+
+            k = std::min(k, counters.size());
+            std::partial_sort(counters.begin(), counters.begin() + static_cast<std::ptrdiff_t>(k), counters.end(), more_frequent);
+            counters.resize(k);
+
+            return counters;
+        }
+
+        // mergeable summaries (Agarwal et al. 2012) - a key missing in one summary is charged with its min_count as count
+        // and error, so the bounds hold for the merged stream; the capacity largest counts are kept
+        void merge(const SpaceSaving& other)
+        {
+            const uint64_t own_min = min_count();
+            const uint64_t other_min = other.min_count();
+
+            std::vector<Counter> merged;
+            merged.reserve(counters_.size() + other.counters_.size());
+
+            for (const auto& counter : counters_)
+            {
+                if (auto it = other.index_.find(counter.key); it != other.index_.end())
+                {
+                    const auto& other_counter = other.counters_[it->second];
+                    merged.push_back({counter.key, counter.count + other_counter.count, counter.error + other_counter.error});
+                }
+                else
+                {
+                    merged.push_back({counter.key, counter.count + other_min, counter.error + other_min});
+                }
+            }
+
+            for (const auto& other_counter : other.counters_)
+                if (index_.find(other_counter.key) == index_.end())
+                    merged.push_back({other_counter.key, other_counter.count + own_min, other_counter.error + own_min});
+
+            if (merged.size() > capacity_)
+            {
+                std::nth_element(merged.begin(), merged.begin() + static_cast<std::ptrdiff_t>(capacity_), merged.end(),
+                    [](const Counter& a, const Counter& b) { return a.count > b.count; });
+                merged.resize(capacity_);
+            }
+
+            const uint64_t total_count = total_count_ + other.total_count_;
+
+            reset();
+            for (auto& counter : merged)
+                push(std::move(counter));
+            total_count_ = total_count;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,2087 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include <algorithm>
+#include <array>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <execution>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "adaptive_policy.hpp"
+#include "allocation_counter.hpp"
+#include "benchmark_results.hpp"
+#include "case_folding.hpp"
+#include "concurrent_hash_map.hpp"
+#include "catch.hpp"
+#include "corpus.hpp"
+#include "count_min_sketch.hpp"
+#include "counter_rng.hpp"
+#include "datasets.hpp"
+#include "fixtures.hpp"
+#include "hashing.hpp"
+#include "hyperloglog.hpp"
+#include "instrumentation.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+#include "primes.hpp"
+#include "radix_sort.hpp"
+#include "scaling_sweep.hpp"
+#include "thread_pool.hpp"
+#include "sort_by_key.hpp"
+#include "space_saving.hpp"
+#include "token_column.hpp"
+#include "tracer.hpp"
+#include "word_count.hpp"
+
+using namespace std::literals;
+
+TEST_CASE("tokenize splits on whitespace like ifstream >> std::string")
+{
+    REQUIRE(Corpus::tokenize("").empty());
+    REQUIRE(Corpus::tokenize(" \t\r\n ").empty());
+    REQUIRE(Corpus::tokenize("one") == Corpus::TokenViews{"one"sv});
+    REQUIRE(Corpus::tokenize("  one\ttwo\r\nthree \v\ffour  ") == Corpus::TokenViews{"one"sv, "two"sv, "three"sv, "four"sv});
+}
+
+TEST_CASE("mapped corpus")
+{
+    SECTION("missing file")
+    {
+        REQUIRE_FALSE(Corpus::load_words_mapped("no_such_file.txt").has_value());
+    }
+
+    SECTION("tokens point into the mapping which outlives moves")
+    {
+        auto corpus = Corpus::load_words_mapped("tokens.txt").value();
+        auto moved_corpus = std::move(corpus);
+
+        const auto content = moved_corpus.content();
+        REQUIRE(moved_corpus.size() > 0);
+        REQUIRE(moved_corpus[1] == "S");
+        REQUIRE(moved_corpus.tokens().back().data() >= content.data());
+        REQUIRE(moved_corpus.tokens().back().data() < content.data() + content.size());
+    }
+}
+
+TEST_CASE("parallel tokenizer")
+{
+    SECTION("chunk edges are moved to whitespace")
+    {
+        const auto chunks = Corpus::split_into_chunks("alpha beta gamma delta", 3);
+
+        REQUIRE(chunks == std::vector{"alpha beta"sv, " gamma delta"sv});
+    }
+
+    SECTION("same tokens as sequential tokenizer for any number of chunks")
+    {
+        const auto text = "  lorem ipsum\tdolor\n\nsit   amet, consectetur adipiscing elit  "sv;
+        const auto expected = Corpus::tokenize(text);
+
+        for (size_t no_of_chunks : {0, 1, 2, 3, 7, 64, 1000})
+        {
+            INFO("no_of_chunks: " << no_of_chunks);
+            REQUIRE(Corpus::tokenize_parallel(text, no_of_chunks) == expected);
+        }
+    }
+
+    SECTION("tokens.txt")
+    {
+        const auto corpus = Corpus::load_words_mapped_parallel("tokens.txt", 8).value();
+
+        REQUIRE(corpus.tokens() == Corpus::tokenize(corpus.content()));
+    }
+}
+
+TEST_CASE("TokenColumn")
+{
+    const std::vector<std::string> tokens = {"one", "", "three", "four"};
+    const Corpus::TokenColumn column{tokens.begin(), tokens.end()};
+
+    REQUIRE(column.size() == 4);
+    REQUIRE(column.bytes() == "onethreefour");
+    REQUIRE(column.offsets() == std::vector<uint32_t>{0, 3, 3, 8, 12});
+    REQUIRE(column[2] == "three");
+    REQUIRE(std::equal(column.begin(), column.end(), tokens.begin(), tokens.end()));
+    REQUIRE(column.end() - column.begin() == 4);
+    REQUIRE(*(column.begin() + 3) == "four");
+
+    SECTION("empty")
+    {
+        Corpus::TokenColumn empty_column;
+
+        REQUIRE(empty_column.empty());
+        REQUIRE(empty_column.begin() == empty_column.end());
+    }
+
+    SECTION("built from mapped corpus")
+    {
+        const auto corpus = Corpus::load_words_mapped("tokens.txt").value();
+        const Corpus::TokenColumn corpus_column{corpus.begin(), corpus.end()};
+
+        REQUIRE(corpus_column.views() == corpus.tokens());
+    }
+}
+
+TEST_CASE("sort_by_key")
+{
+    auto to_lower = [](std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return s;
+    };
+
+    std::vector<std::string> data = {"delta", "Alpha", "charlie", "ALPHA", "Bravo", "alpha", "echo"};
+
+    auto expected = data;
+    std::stable_sort(expected.begin(), expected.end(), [&](const auto& a, const auto& b) { return to_lower(a) < to_lower(b); });
+
+    SECTION("sequenced")
+    {
+        Algorithms::sort_by_key(data.begin(), data.end(), to_lower);
+        REQUIRE(data == expected);
+    }
+
+    SECTION("parallel")
+    {
+        Algorithms::sort_by_key(std::execution::par, data.begin(), data.end(), to_lower);
+        REQUIRE(data == expected);
+    }
+
+    SECTION("custom key comparer")
+    {
+        Algorithms::sort_by_key(data.begin(), data.end(), [](const std::string& s) { return s.size(); }, std::greater{});
+        REQUIRE(data == std::vector<std::string>{"charlie", "delta", "Alpha", "ALPHA", "Bravo", "alpha", "echo"});
+    }
+
+    SECTION("move-only items without a default constructor")
+    {
+        struct Item
+        {
+            std::unique_ptr<int> value;
+
+            explicit Item(int v) : value{std::make_unique<int>(v)}
+            {
+            }
+        };
+
+        std::vector<Item> items;
+        for (int v : {5, 3, 9, 1, 3, 7, 0, 8, 2})
+            items.emplace_back(v);
+
+        Algorithms::sort_by_key(std::execution::par, items.begin(), items.end(), [](const Item& item) { return *item.value; });
+
+        std::vector<int> values;
+        std::transform(items.begin(), items.end(), std::back_inserter(values), [](const Item& item) { return *item.value; });
+        REQUIRE(values == std::vector<int>{0, 1, 2, 3, 3, 5, 7, 8, 9});
+    }
+}
+
+TEST_CASE("radix sort")
+{
+    std::mt19937_64 rnd_gen{665};
+    std::uniform_int_distribution<size_t> rnd_length(0, 40);
+    std::uniform_int_distribution<int> rnd_char(0, 5);
+    const std::string prefixes[] = {"", "pre", "prefix", "PREFIX_shared_", "\xC5\xBC"};
+
+    std::vector<std::string> data(100'000);
+    std::generate(data.begin(), data.end(), [&] {
+        std::string s = prefixes[rnd_gen() % std::size(prefixes)];
+        for (size_t length = rnd_length(rnd_gen); length > 0; --length)
+            s += "aAbBz\xFF"[rnd_char(rnd_gen)];
+        return s;
+    });
+
+    auto to_lower = [](std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return s;
+    };
+
+    SECTION("byte order of std::string")
+    {
+        auto expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        Algorithms::radix_sort(data.begin(), data.end());
+        REQUIRE(data == expected);
+    }
+
+    SECTION("parallel, std::string_view")
+    {
+        std::vector<std::string_view> views(data.begin(), data.end());
+        auto expected = views;
+        std::sort(expected.begin(), expected.end());
+
+        Algorithms::radix_sort(std::execution::par, views.begin(), views.end());
+        REQUIRE(views == expected);
+    }
+
+    SECTION("case folding")
+    {
+        std::vector<std::string> expected(data.size());
+        std::transform(data.begin(), data.end(), expected.begin(), to_lower);
+        std::sort(expected.begin(), expected.end());
+
+        Algorithms::radix_sort(std::execution::par, data.begin(), data.end(), Algorithms::ascii_lower_bytes);
+
+        std::transform(data.begin(), data.end(), data.begin(), to_lower);
+        REQUIRE(data == expected);
+    }
+
+    SECTION("long shared prefixes")
+    {
+        std::vector<std::string> long_strings(1000, std::string(10'000, 'x'));
+        for (size_t i = 0; i < long_strings.size(); ++i)
+            long_strings[i] += std::to_string(long_strings.size() - i);
+
+        auto expected = long_strings;
+        std::sort(expected.begin(), expected.end());
+
+        Algorithms::radix_sort(long_strings.begin(), long_strings.end());
+        REQUIRE(long_strings == expected);
+    }
+
+    SECTION("string-like items without a default constructor")
+    {
+        struct Word
+        {
+            std::string text;
+
+            explicit Word(std::string t) : text{std::move(t)}
+            {
+            }
+
+            operator std::string_view() const
+            {
+                return text;
+            }
+        };
+
+        auto expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<Word> words;
+        for (const auto &s : data)
+            words.emplace_back(s);
+
+        std::vector<Word> parallel_words = words;
+
+        Algorithms::radix_sort(words.begin(), words.end());
+        Algorithms::radix_sort(std::execution::par, parallel_words.begin(), parallel_words.end());
+
+        for (const auto *sorted : {&words, &parallel_words})
+        {
+            std::vector<std::string> texts;
+            std::transform(sorted->begin(), sorted->end(), std::back_inserter(texts), [](const Word& word) { return word.text; });
+            REQUIRE(texts == expected);
+        }
+    }
+}
+
+TEST_CASE("ASCII case folding")
+{
+    std::string all_bytes;
+    for (int round = 0; round < 3; ++round)
+        for (int c = 0; c < 256; ++c)
+            all_bytes += static_cast<char>(c);
+
+    auto c_locale_to_lower = [](std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return s;
+    };
+
+    for (auto kernel : {Corpus::CaseFoldingKernel::scalar, Corpus::CaseFoldingKernel::sse2, Corpus::CaseFoldingKernel::avx2, Corpus::CaseFoldingKernel::best})
+    {
+        INFO("kernel: " << static_cast<int>(kernel));
+
+        // all bytes, every offset and length - same as tolower in "C" locale
+        for (size_t offset = 0; offset < 40; ++offset)
+            for (size_t length : {0, 1, 15, 16, 17, 31, 32, 33, 100, 700})
+            {
+                const auto text = std::string_view{all_bytes}.substr(offset, length);
+                REQUIRE(Corpus::to_lower_ascii_copy(text, kernel) == c_locale_to_lower(std::string(text)));
+            }
+
+        std::string text = "Remembrance Of THINGS Past - Volume ONE, by Marcel PROUST";
+        Corpus::to_lower_ascii(text, kernel);
+        REQUIRE(text == "remembrance of things past - volume one, by marcel proust");
+    }
+
+    SECTION("token column")
+    {
+        const std::vector<std::string> tokens = {"SWANN", "Way", "", "aLa", "Recherche"};
+        Corpus::TokenColumn column{tokens.begin(), tokens.end()};
+
+        Corpus::to_lower_ascii(column);
+        REQUIRE(column.views() == std::vector{"swann"sv, "way"sv, ""sv, "ala"sv, "recherche"sv});
+    }
+}
+
+TEST_CASE("segmented sieve")
+{
+    const auto reference_primes = Primes::odd_primes_up_to(1'000'000);
+    auto is_prime_reference = [&](uint64_t n) {
+        return n == 2 || (n % 2 == 1 && std::binary_search(reference_primes.begin(), reference_primes.end(), n));
+    };
+
+    REQUIRE(Primes::isqrt(0) == 0);
+    REQUIRE(Primes::isqrt(99) == 9);
+    REQUIRE(Primes::isqrt(100) == 10);
+    REQUIRE(Primes::isqrt(UINT64_MAX) == 4294967295ULL);
+
+    std::vector<uint64_t> numbers(1'001);
+    std::iota(numbers.begin(), numbers.end(), 999'000);
+    numbers.insert(numbers.end(), {0, 1, 2, 3, 4, 9, 25, 997, 997, 65'537, 65'539});
+    std::shuffle(numbers.begin(), numbers.end(), std::mt19937_64{42});
+
+    std::vector<uint8_t> expected(numbers.size());
+    std::transform(numbers.begin(), numbers.end(), expected.begin(), is_prime_reference);
+
+    for (size_t segment_size : {1, 7, 1000, 32 * 1024})
+    {
+        INFO("segment_size: " << segment_size);
+        const Primes::SegmentedSieve sieve{segment_size};
+
+        REQUIRE(sieve.are_primes(numbers) == expected);
+        REQUIRE(sieve.are_primes(std::execution::par, numbers) == expected);
+
+        auto numbers_to_part = numbers;
+        const auto boundary = sieve.partition(std::execution::par, numbers_to_part.begin(), numbers_to_part.end());
+        REQUIRE(std::all_of(numbers_to_part.begin(), boundary, is_prime_reference));
+        REQUIRE(std::none_of(boundary, numbers_to_part.end(), is_prime_reference));
+    }
+
+    SECTION("dense range")
+    {
+        std::vector<uint64_t> dense_numbers(5'000);
+        std::iota(dense_numbers.begin(), dense_numbers.end(), 0);
+        std::vector<uint8_t> dense_expected(dense_numbers.size());
+        std::transform(dense_numbers.begin(), dense_numbers.end(), dense_expected.begin(), is_prime_reference);
+
+        REQUIRE(Primes::SegmentedSieve{100}.are_primes(std::execution::par, dense_numbers) == dense_expected);
+        REQUIRE(Primes::SegmentedSieve{}.are_primes({3}) == std::vector<uint8_t>{1});
+    }
+
+    SECTION("large numbers")
+    {
+        const Primes::SegmentedSieve sieve;
+        REQUIRE(sieve.are_primes({1'000'000'007, 1'000'000'009, 1'000'000'011, 999'999'999'989}) == std::vector<uint8_t>{1, 1, 0, 1});
+    }
+
+    SECTION("numbers above the sieved range")
+    {
+        const uint64_t max_sieved = Primes::SegmentedSieve::max_sieved_value;
+        const std::vector<uint64_t> numbers = {max_sieved - 1, max_sieved + 1, 9'223'372'036'854'775'783ULL, 9'223'372'036'854'775'807ULL,
+            18'446'744'073'709'551'557ULL, UINT64_MAX, 1'000'000'007};
+
+        std::vector<uint8_t> expected(numbers.size());
+        std::transform(numbers.begin(), numbers.end(), expected.begin(), [](uint64_t n) { return Primes::is_prime_miller_rabin(n); });
+
+        REQUIRE(Primes::SegmentedSieve{}.are_primes(numbers) == expected);
+        REQUIRE(Primes::SegmentedSieve{}.are_primes(std::execution::par, numbers) == expected);
+        REQUIRE(expected == std::vector<uint8_t>{0, 0, 1, 0, 1, 0, 1});
+    }
+}
+
+TEST_CASE("Miller-Rabin")
+{
+    const auto odd_primes = Primes::odd_primes_up_to(100'000);
+
+    for (uint64_t n = 0; n <= 100'000; ++n)
+    {
+        const bool expected = n == 2 || (n % 2 == 1 && std::binary_search(odd_primes.begin(), odd_primes.end(), n));
+        if (Primes::is_prime_miller_rabin(n) != expected)
+            FAIL("n = " << n);
+    }
+
+    SECTION("strong pseudoprimes and Carmichael numbers")
+    {
+        for (uint64_t n : {561ULL, 41'041ULL, 3'215'031'751ULL, 2'152'302'898'747ULL, 3'474'749'660'383ULL, 341'550'071'728'321ULL, 3'825'123'056'546'413'051ULL})
+        {
+            INFO("n = " << n);
+            REQUIRE_FALSE(Primes::is_prime_miller_rabin(n));
+        }
+    }
+
+    SECTION("64-bit boundaries")
+    {
+        REQUIRE(Primes::is_prime_miller_rabin(1'000'000'007));
+        REQUIRE(Primes::is_prime_miller_rabin((1ULL << 61) - 1));
+        REQUIRE(Primes::is_prime_miller_rabin(18'446'744'073'709'551'557ULL)); // largest 64-bit prime
+        REQUIRE_FALSE(Primes::is_prime_miller_rabin(18'446'744'073'709'551'615ULL));
+        REQUIRE_FALSE(Primes::is_prime_miller_rabin(4'294'967'291ULL * 4'294'967'279ULL));
+    }
+
+    SECTION("agrees with segmented sieve on a window of large numbers")
+    {
+        std::vector<uint64_t> window(10'000);
+        std::iota(window.begin(), window.end(), 1'000'000'000'000ULL);
+
+        const auto expected = Primes::SegmentedSieve{}.are_primes(window);
+        for (size_t i = 0; i < window.size(); ++i)
+            REQUIRE(Primes::is_prime_miller_rabin(window[i]) == static_cast<bool>(expected[i]));
+    }
+}
+
+TEST_CASE("compile-time prime table")
+{
+    constexpr auto bitmap = Primes::create_prime_bitmap<1000>();
+
+    static_assert(bitmap.size() == 8);
+    static_assert(!Primes::is_prime_in_bitmap(bitmap, 0));
+    static_assert(!Primes::is_prime_in_bitmap(bitmap, 1));
+    static_assert(Primes::is_prime_in_bitmap(bitmap, 2));
+    static_assert(Primes::is_prime_in_bitmap(bitmap, 997));
+    static_assert(!Primes::is_prime_in_bitmap(bitmap, 999));
+    static_assert(Primes::is_prime_in_bitmap(Primes::small_primes_bitmap, 1'048'573));
+
+    const auto odd_primes = Primes::odd_primes_up_to(Primes::small_primes_limit + 1'000);
+
+    for (uint64_t n = 0; n <= Primes::small_primes_limit + 1'000; ++n)
+    {
+        const bool expected = n == 2 || (n % 2 == 1 && std::binary_search(odd_primes.begin(), odd_primes.end(), n));
+        if (Primes::is_prime(n) != expected)
+            FAIL("n = " << n);
+    }
+
+    uint64_t no_of_primes = 0;
+    for (uint64_t n = 0; n <= Primes::small_primes_limit; ++n)
+        no_of_primes += Primes::is_prime_in_bitmap(Primes::small_primes_bitmap, n);
+
+    REQUIRE(no_of_primes == 82'025); // pi(2^20)
+}
+
+TEST_CASE("Chase-Lev deque")
+{
+    struct CountingTask : Concurrency::Task
+    {
+        std::atomic<int>* counter;
+
+        explicit CountingTask(std::atomic<int>* counter)
+            : counter{counter}
+        {
+        }
+
+        void execute() override
+        {
+            ++*counter;
+        }
+    };
+
+    SECTION("owner pops LIFO, thieves steal FIFO, buffer grows")
+    {
+        std::atomic<int> counter{0};
+        std::vector<CountingTask> tasks(10, CountingTask{&counter});
+        Concurrency::ChaseLevDeque deque{2};
+
+        for (auto& task : tasks)
+            deque.push(&task);
+
+        REQUIRE(deque.size() == 10);
+        REQUIRE(deque.pop() == &tasks[9]);
+        REQUIRE(deque.steal() == &tasks[0]);
+        REQUIRE(deque.steal() == &tasks[1]);
+        REQUIRE(deque.pop() == &tasks[8]);
+        REQUIRE(deque.size() == 6);
+    }
+
+    SECTION("every task is taken exactly once under concurrent stealing")
+    {
+        const int no_of_tasks = 100'000;
+        std::atomic<int> counter{0};
+        std::vector<CountingTask> tasks(no_of_tasks, CountingTask{&counter});
+        Concurrency::ChaseLevDeque deque{16};
+        std::atomic<bool> is_done{false};
+
+        std::vector<std::thread> thieves;
+        for (int i = 0; i < 3; ++i)
+            thieves.emplace_back([&] {
+                while (!is_done)
+                    if (auto* task = deque.steal())
+                        task->execute();
+            });
+
+        for (int i = 0; i < no_of_tasks; ++i)
+        {
+            deque.push(&tasks[i]);
+            if (i % 3 == 0)
+                if (auto* task = deque.pop())
+                    task->execute();
+        }
+
+        while (auto* task = deque.pop())
+            task->execute();
+
+        while (deque.size() > 0)
+            std::this_thread::yield();
+
+        is_done = true;
+        for (auto& thief : thieves)
+            thief.join();
+
+        REQUIRE(counter == no_of_tasks);
+    }
+}
+
+TEST_CASE("work-stealing thread pool")
+{
+    Concurrency::ThreadPool pool{4};
+    REQUIRE(pool.size() == 4);
+
+    SECTION("parallel_for visits every index once, including nested loops")
+    {
+        std::vector<std::atomic<int>> visits(10'000);
+
+        Concurrency::parallel_for(pool, 0, 100, [&](int i) {
+            Concurrency::parallel_for(pool, i * 100, (i + 1) * 100, [&](int j) { ++visits[j]; }, 7);
+        }, 1);
+
+        REQUIRE(std::all_of(visits.begin(), visits.end(), [](const auto& v) { return v == 1; }));
+    }
+
+    SECTION("parallel_reduce")
+    {
+        std::vector<uint64_t> data(100'001);
+        std::iota(data.begin(), data.end(), 0);
+
+        REQUIRE(Concurrency::parallel_reduce(pool, data.begin(), data.end(), uint64_t{0}, std::plus{}, [](uint64_t x) { return x * x; })
+            == std::transform_reduce(data.begin(), data.end(), uint64_t{0}, std::plus{}, [](uint64_t x) { return x * x; }));
+
+        const std::vector<std::string> letters = {"a", "b", "c", "d", "e", "f", "g"};
+        REQUIRE(Concurrency::parallel_reduce(pool, letters.begin(), letters.end(), std::string{">"}, std::plus{}, [](const auto& s) { return s; }, 2) == ">abcdefg");
+    }
+
+    SECTION("parallel_transform")
+    {
+        std::vector<int> data(50'000);
+        std::iota(data.begin(), data.end(), 0);
+        std::vector<int> result(data.size());
+
+        Concurrency::parallel_transform(pool, data.begin(), data.end(), result.begin(), [](int x) { return 2 * x; });
+
+        for (size_t i = 0; i < data.size(); ++i)
+            REQUIRE(result[i] == 2 * data[i]);
+    }
+
+    SECTION("parallel_sort")
+    {
+        std::vector<int> data(200'000);
+        std::generate(data.begin(), data.end(), std::mt19937{7});
+        auto expected = data;
+        std::sort(expected.begin(), expected.end(), std::greater{});
+
+        Concurrency::parallel_sort(pool, data.begin(), data.end(), std::greater{}, 1000);
+        REQUIRE(data == expected);
+    }
+
+    SECTION("parallel_partition")
+    {
+        std::vector<int> data(100'003);
+        std::generate(data.begin(), data.end(), std::mt19937{13});
+        auto sorted_input = data;
+        std::sort(sorted_input.begin(), sorted_input.end());
+
+        auto is_odd = [](int x) { return x % 2 != 0; };
+        const auto boundary = Concurrency::parallel_partition(pool, data.begin(), data.end(), is_odd);
+
+        REQUIRE(boundary - data.begin() == std::count_if(sorted_input.begin(), sorted_input.end(), is_odd));
+        REQUIRE(std::is_partitioned(data.begin(), data.end(), is_odd));
+        std::sort(data.begin(), data.end());
+        REQUIRE(data == sorted_input);
+    }
+
+    SECTION("exception thrown by a task is rethrown by the waiting thread")
+    {
+        REQUIRE_THROWS_AS(Concurrency::parallel_for(pool, 0, 1000, [](int i) {
+            if (i == 665)
+                throw std::runtime_error("error");
+        }, 10), std::runtime_error);
+    }
+}
+
+TEST_CASE("Mann-Whitney U test")
+{
+    SECTION("separated samples")
+    {
+        auto result = Benchmarking::mann_whitney_u({1, 2, 3, 4, 5}, {6, 7, 8, 9, 10});
+
+        REQUIRE(result.u == Approx(25.0));
+        REQUIRE(result.z == Approx(2.5067).epsilon(0.001));
+        REQUIRE(result.p_value == Approx(0.00609).epsilon(0.01));
+
+        REQUIRE(Benchmarking::mann_whitney_u({6, 7, 8, 9, 10}, {1, 2, 3, 4, 5}).p_value > 0.99);
+    }
+
+    SECTION("ties get average ranks")
+    {
+        auto result = Benchmarking::mann_whitney_u({1, 2, 2, 3}, {2, 3, 3, 4});
+
+        REQUIRE(result.u == Approx(13.0));
+        REQUIRE(result.p_value > 0.05);
+    }
+
+    SECTION("identical samples are not significant")
+    {
+        auto result = Benchmarking::mann_whitney_u({5, 5, 5}, {5, 5, 5});
+
+        REQUIRE(result.p_value == Approx(1.0));
+    }
+}
+
+namespace
+{
+    Benchmarking::BenchmarkResult benchmark_result(std::string test_case, std::string name, std::vector<double> samples)
+    {
+        Benchmarking::BenchmarkResult result;
+        result.test_case = std::move(test_case);
+        result.name = std::move(name);
+        result.iterations = 1;
+        result.mean.point = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        result.mean.lower_bound = result.mean.point;
+        result.mean.upper_bound = result.mean.point;
+        result.outliers.samples_seen = static_cast<int>(samples.size());
+        result.samples = std::move(samples);
+        return result;
+    }
+}
+
+TEST_CASE("benchmark results")
+{
+    Benchmarking::BenchmarkResults results = {
+        benchmark_result("sort", "radix \"sort\" - seq", {100.25, 101.5, 99.75}),
+        benchmark_result("transform", "prime table", {1e-3, 2.5e9})};
+    results[0].standard_deviation = {0.5, 0.25, 0.75};
+    results[0].outliers.high_mild = 1;
+    results[0].outlier_variance = 0.125;
+    results[0].counters = Benchmarking::PerfSample{};
+    results[0].counters->runs = 4;
+    results[0].counters->no_of_elements = 10;
+    results[0].counters->counts.values[static_cast<size_t>(Benchmarking::PerfEvent::cycles)] = 1000.0;
+    results[0].counters->counts.values[static_cast<size_t>(Benchmarking::PerfEvent::cache_misses)] = 80.0;
+    results[1].latencies.emplace();
+    results[1].latencies->record(1'000, 99);
+    results[1].latencies->record(2'000'000, 1);
+
+    SECTION("JSON round trip")
+    {
+        std::stringstream json;
+        Benchmarking::write_json(json, results);
+
+        auto read = Benchmarking::read_json(json);
+
+        REQUIRE(read.size() == 2);
+        REQUIRE(read[0].id() == "sort/radix \"sort\" - seq");
+        REQUIRE(read[0].samples == results[0].samples);
+        REQUIRE(read[0].mean.point == results[0].mean.point);
+        REQUIRE(read[0].standard_deviation.upper_bound == 0.75);
+        REQUIRE(read[0].outliers.high_mild == 1);
+        REQUIRE(read[0].outlier_variance == 0.125);
+        REQUIRE(read[1].samples == results[1].samples);
+
+        REQUIRE(read[0].counters);
+        REQUIRE(read[0].counters->runs == 4);
+        REQUIRE(read[0].counters->counts[Benchmarking::PerfEvent::cycles] == 1000.0);
+        REQUIRE_FALSE(read[0].counters->counts[Benchmarking::PerfEvent::instructions]);
+        REQUIRE_FALSE(read[1].counters);
+
+        REQUIRE_FALSE(read[0].latencies);
+        REQUIRE(read[1].latencies);
+        REQUIRE(read[1].latencies->dump() == results[1].latencies->dump());
+        REQUIRE(json.str().find("\"p99_9\": ") != std::string::npos);
+    }
+
+    SECTION("malformed JSON")
+    {
+        std::stringstream json{"{ \"benchmarks\": [ { \"name\": 1 } ] }"};
+
+        REQUIRE_THROWS_AS(Benchmarking::read_json(json), std::runtime_error);
+    }
+
+    SECTION("CSV has a header and a row per benchmark")
+    {
+        std::stringstream csv;
+        Benchmarking::write_csv(csv, results);
+
+        std::string line;
+        std::vector<std::string> lines;
+        while (std::getline(csv, line))
+            lines.push_back(line);
+
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines[1].find(",250,,,2,,,,,,,,,,,\"") != std::string::npos);
+        REQUIRE(lines[1].rfind("\"sort\",\"radix \"\"sort\"\" - seq\",1,", 0) == 0);
+    }
+
+    SECTION("comparison with baseline")
+    {
+        std::vector<double> baseline_samples(50);
+        std::iota(baseline_samples.begin(), baseline_samples.end(), 100.0);
+
+        std::vector<double> slower_samples(baseline_samples);
+        for (auto& sample : slower_samples)
+            sample *= 1.5;
+
+        std::vector<double> noisy_samples(baseline_samples.rbegin(), baseline_samples.rend());
+        noisy_samples.front() += 10.0;
+
+        Benchmarking::BenchmarkResults baseline = {benchmark_result("a", "slower", baseline_samples), benchmark_result("a", "same", baseline_samples),
+            benchmark_result("a", "removed", baseline_samples)};
+        Benchmarking::BenchmarkResults current = {benchmark_result("a", "slower", slower_samples), benchmark_result("a", "same", noisy_samples),
+            benchmark_result("a", "added", baseline_samples)};
+
+        auto comparisons = Benchmarking::compare_with_baseline(baseline, current, 0.05, 0.05);
+
+        REQUIRE(comparisons.size() == 2);
+        REQUIRE(comparisons[0].id == "a/slower");
+        REQUIRE(comparisons[0].change == Approx(0.5));
+        REQUIRE(comparisons[0].is_regression);
+        REQUIRE(comparisons[1].id == "a/same");
+        REQUIRE_FALSE(comparisons[1].is_regression);
+    }
+}
+
+TEST_CASE("hardware counters")
+{
+    SECTION("derived metrics")
+    {
+        Benchmarking::PerfSample sample;
+        sample.runs = 2;
+        sample.no_of_elements = 100;
+
+        REQUIRE_FALSE(sample.instructions_per_cycle());
+
+        sample.counts.values[static_cast<size_t>(Benchmarking::PerfEvent::cycles)] = 4000.0;
+        sample.counts.values[static_cast<size_t>(Benchmarking::PerfEvent::instructions)] = 6000.0;
+        sample.counts.values[static_cast<size_t>(Benchmarking::PerfEvent::branch_misses)] = 50.0;
+
+        REQUIRE(*sample.instructions_per_cycle() == Approx(1.5));
+        REQUIRE(*sample.per_run(Benchmarking::PerfEvent::cycles) == Approx(2000.0));
+        REQUIRE(*sample.per_element(Benchmarking::PerfEvent::branch_misses) == Approx(0.25));
+        REQUIRE_FALSE(sample.per_element(Benchmarking::PerfEvent::llc_loads));
+
+        Benchmarking::PerfCounts more;
+        more.values[static_cast<size_t>(Benchmarking::PerfEvent::llc_loads)] = 10.0;
+        more.values[static_cast<size_t>(Benchmarking::PerfEvent::cycles)] = 1000.0;
+        sample.counts += more;
+
+        REQUIRE(*sample.counts[Benchmarking::PerfEvent::cycles] == Approx(5000.0));
+        REQUIRE(*sample.counts[Benchmarking::PerfEvent::llc_loads] == Approx(10.0));
+    }
+
+    SECTION("counters are either available or explain why not")
+    {
+        Benchmarking::PerfCounters counters;
+
+        if (counters.is_available())
+        {
+            counters.start();
+            volatile uint64_t sum = 0;
+            for (uint64_t i = 0; i < 100'000; ++i)
+                sum = sum + i;
+            auto counts = counters.stop();
+
+            REQUIRE_FALSE(counts.empty());
+        }
+        else
+        {
+            REQUIRE_FALSE(counters.error().empty());
+            REQUIRE(counters.stop().empty());
+        }
+    }
+}
+
+TEST_CASE("scaling sweep harness")
+{
+    Benchmarking::SweepConfig config;
+    config.min_size = 1000;
+    config.max_size = 5000;
+    config.max_threads = 2;
+    config.min_repetitions = 2;
+    config.min_time_per_point = std::chrono::nanoseconds{0};
+
+    REQUIRE(config.sizes() == std::vector<size_t>{1024, 2048, 4096});
+    REQUIRE(config.thread_counts() == std::vector<size_t>{1, 2});
+
+    SECTION("runs every algorithm on every point of the grid")
+    {
+        std::vector<size_t> sizes_seen;
+
+        auto result = Benchmarking::run_sweep(
+            "sort", config,
+            [&](size_t size) {
+                sizes_seen.push_back(size);
+                std::vector<int> data(size);
+                std::iota(data.rbegin(), data.rend(), 0);
+                return data;
+            },
+            [](auto& data) { std::sort(data.begin(), data.end()); },
+            [](auto& data, auto& pool) {
+                Concurrency::parallel_sort(pool, data.begin(), data.end());
+                REQUIRE(std::is_sorted(data.begin(), data.end()));
+            });
+
+        REQUIRE(sizes_seen == config.sizes());
+        REQUIRE(result.points.size() == 6);
+        REQUIRE(result.points[5].size == 4096);
+        REQUIRE(result.points[5].no_of_threads == 2);
+        REQUIRE(result.points[5].sequential_ns > 0.0);
+        REQUIRE(result.points[5].parallel_ns > 0.0);
+    }
+
+    SECTION("break-even size is the first size from which parallel version stays faster")
+    {
+        Benchmarking::SweepResult result{"test",
+            {{1024, 1, 100, 200}, {1024, 2, 100, 200}, {2048, 1, 200, 100}, {2048, 2, 200, 400}, {4096, 1, 400, 200}, {4096, 2, 400, 100}}};
+
+        REQUIRE(result.points[5].speedup() == Approx(4.0));
+        REQUIRE(result.points[5].efficiency() == Approx(2.0));
+        REQUIRE(result.break_even_size(1) == 2048u);
+        REQUIRE(result.break_even_size(2) == 4096u);
+        REQUIRE_FALSE(result.break_even_size(3));
+    }
+}
+
+TEST_CASE("allocation counter")
+{
+    SECTION("allocations are counted only while counting")
+    {
+        const auto before = Benchmarking::allocation_counts();
+        auto not_counted = std::make_unique<std::array<char, 100>>();
+
+        Benchmarking::reset_peak_live_bytes();
+        const auto live_before = Benchmarking::live_bytes();
+
+        Benchmarking::start_counting_allocations();
+        auto counted = std::make_unique<std::array<char, 1000>>();
+        std::vector<int> numbers(250);
+        const auto numbers_block_size = static_cast<int64_t>(Benchmarking::allocated_block_size(numbers.data()));
+        numbers = std::vector<int>();
+        Benchmarking::stop_counting_allocations();
+
+        const auto counts = Benchmarking::allocation_counts() - before;
+        const auto live = Benchmarking::live_bytes() - live_before;
+        const auto peak = Benchmarking::peak_live_bytes() - live_before;
+        const auto counted_block_size = static_cast<int64_t>(Benchmarking::allocated_block_size(counted.get()));
+
+        Benchmarking::start_counting_allocations();
+        counted.reset();
+        Benchmarking::stop_counting_allocations();
+        not_counted.reset();
+
+        REQUIRE(counts.allocations == 2);
+        REQUIRE(counts.deallocations == 1);
+        REQUIRE(counts.bytes_allocated == 2000);
+        REQUIRE(counted_block_size >= 1000);
+        REQUIRE(live == counted_block_size);
+        REQUIRE(peak == counted_block_size + numbers_block_size);
+        REQUIRE((Benchmarking::allocation_counts() - before).deallocations == 2);
+        REQUIRE(Benchmarking::live_bytes() == live_before);
+    }
+
+    SECTION("aligned, array and nothrow forms")
+    {
+        struct alignas(128) Aligned
+        {
+            char bytes[128];
+        };
+
+        const auto before = Benchmarking::allocation_counts();
+
+        Benchmarking::start_counting_allocations();
+        auto aligned = std::make_unique<Aligned[]>(3);
+        auto* nothrow = new (std::nothrow) int{42};
+        Benchmarking::stop_counting_allocations();
+
+        const bool is_aligned = reinterpret_cast<uintptr_t>(aligned.get()) % 128 == 0;
+        const auto counts = Benchmarking::allocation_counts() - before;
+        aligned.reset();
+        delete nothrow;
+
+        REQUIRE(is_aligned);
+        REQUIRE(counts.allocations == 2);
+        REQUIRE(counts.bytes_allocated >= 3 * 128 + sizeof(int));
+    }
+
+    SECTION("allocations of worker threads are summed")
+    {
+        const auto before = Benchmarking::allocation_counts();
+
+        Benchmarking::start_counting_allocations();
+        std::vector<std::thread> threads;
+        threads.reserve(4);
+        for (int i = 0; i < 4; ++i)
+            threads.emplace_back([] { auto bytes = std::make_unique<std::vector<char>>(500); });
+        for (auto& thread : threads)
+            thread.join();
+        Benchmarking::stop_counting_allocations();
+
+        const auto counts = Benchmarking::allocation_counts() - before;
+
+        REQUIRE(counts.allocations >= 8);
+        REQUIRE(counts.bytes_allocated >= 4 * 500);
+    }
+}
+
+namespace
+{
+    struct FakeMeter
+    {
+        int no_of_runs;
+
+        int runs() const
+        {
+            return no_of_runs;
+        }
+
+        template <typename Fun>
+        void measure(Fun&& fun)
+        {
+            for (int i = 0; i < no_of_runs; ++i)
+                fun();
+        }
+    };
+}
+
+TEST_CASE("measure collects allocations per run")
+{
+    auto& recorder = Benchmarking::allocation_recorder();
+    recorder.is_enabled = true;
+    recorder.current = Benchmarking::AllocationSample{};
+
+    FakeMeter meter{5};
+    size_t block_size = 0;
+    Benchmarking::measure(meter, 10, [&] {
+        std::vector<int> numbers(64);
+        block_size = Benchmarking::allocated_block_size(numbers.data());
+        return numbers.size();
+    });
+
+    const auto sample = *recorder.current;
+    recorder.is_enabled = false;
+    recorder.current.reset();
+
+    REQUIRE(sample.runs == 5);
+    REQUIRE(sample.allocations_per_run() == Approx(1.0));
+    REQUIRE(sample.bytes_per_run() == Approx(64 * sizeof(int)));
+    REQUIRE(block_size >= 64 * sizeof(int));
+    REQUIRE(sample.peak_live_bytes == static_cast<int64_t>(block_size));
+}
+
+TEST_CASE("measure - blocks allocated by a worker and freed by another thread")
+{
+    auto& recorder = Benchmarking::allocation_recorder();
+    recorder.is_enabled = true;
+    recorder.current = Benchmarking::AllocationSample{};
+
+    const auto live_before = Benchmarking::live_bytes();
+
+    FakeMeter meter{5};
+    Benchmarking::measure(meter, 1, [] {
+        std::unique_ptr<std::array<char, 1000>> block;
+        std::thread worker{[&] { block = std::make_unique<std::array<char, 1000>>(); }};
+        worker.join();
+        block.reset(); // freed by the measuring thread
+        return 0;
+    });
+
+    const auto sample = *recorder.current;
+    recorder.is_enabled = false;
+    recorder.current.reset();
+
+    REQUIRE(sample.runs == 5);
+    REQUIRE(sample.counts.allocations >= 5);
+    REQUIRE(sample.counts.deallocations == sample.counts.allocations);
+    REQUIRE(sample.peak_live_bytes >= 1000);
+    REQUIRE(sample.peak_live_bytes < 2000); // one block at a time - the peak does not grow with the number of runs
+    REQUIRE(Benchmarking::live_bytes() == live_before);
+}
+
+TEST_CASE("latency histogram")
+{
+    Benchmarking::LatencyHistogram histogram{3};
+
+    SECTION("empty")
+    {
+        REQUIRE(histogram.total_count() == 0);
+        REQUIRE(histogram.value_at_percentile(99.0) == 0);
+        REQUIRE(histogram.max() == 0);
+    }
+
+    SECTION("values below 2048 are exact with 3 significant digits")
+    {
+        for (int64_t value = 1; value <= 1000; ++value)
+            histogram.record(value);
+
+        REQUIRE(histogram.total_count() == 1000);
+        REQUIRE(histogram.min() == 1);
+        REQUIRE(histogram.max() == 1000);
+        REQUIRE(histogram.value_at_percentile(50.0) == 500);
+        REQUIRE(histogram.value_at_percentile(99.0) == 990);
+        REQUIRE(histogram.value_at_percentile(99.9) == 999);
+        REQUIRE(histogram.value_at_percentile(100.0) == 1000);
+        REQUIRE(histogram.mean() == Approx(500.5));
+    }
+
+    SECTION("large values keep the relative precision")
+    {
+        const int64_t value = 123'456'789;
+        histogram.record(value);
+
+        REQUIRE(histogram.lowest_equivalent(value) <= value);
+        REQUIRE(histogram.highest_equivalent(value) >= value);
+        REQUIRE(histogram.highest_equivalent(value) - histogram.lowest_equivalent(value) < value / 1000);
+        REQUIRE(histogram.value_at_percentile(50.0) == value);
+    }
+
+    SECTION("tail is visible in high percentiles")
+    {
+        histogram.record(1'000, 9'900);
+        histogram.record(1'000'000, 90);
+        histogram.record(50'000'000, 10);
+
+        REQUIRE(histogram.value_at_percentile(50.0) == 1'000);
+        REQUIRE(histogram.value_at_percentile(99.0) == 1'000);
+        REQUIRE(histogram.value_at_percentile(99.5) == Approx(1'000'000).epsilon(0.001));
+        REQUIRE(histogram.value_at_percentile(99.95) == 50'000'000);
+    }
+
+    SECTION("values outside of the range are clamped")
+    {
+        Benchmarking::LatencyHistogram narrow{2, 1, 1'000'000};
+        narrow.record(-5);
+        narrow.record(5'000'000'000);
+
+        REQUIRE(narrow.total_count() == 2);
+        REQUIRE(narrow.min() == 0);
+        REQUIRE(narrow.max() == 1'000'000);
+    }
+
+    SECTION("merge")
+    {
+        Benchmarking::LatencyHistogram other{3};
+        histogram.record(100, 3);
+        other.record(100'000, 1);
+        other.record(100, 1);
+
+        histogram.merge(other);
+
+        REQUIRE(histogram.total_count() == 5);
+        REQUIRE(histogram.value_at_percentile(80.0) == 100);
+        REQUIRE(histogram.max() == 100'000);
+
+        REQUIRE_THROWS_AS(histogram.merge(Benchmarking::LatencyHistogram{2}), std::invalid_argument);
+    }
+
+    SECTION("dump round trip")
+    {
+        histogram.record(7, 2);
+        histogram.record(3'000'000'000, 1);
+
+        auto parsed = Benchmarking::LatencyHistogram::parse(histogram.dump());
+
+        REQUIRE(parsed.dump() == histogram.dump());
+        REQUIRE(parsed.total_count() == 3);
+        REQUIRE(parsed.min() == 7);
+        REQUIRE(parsed.value_at_percentile(100.0) == histogram.value_at_percentile(100.0));
+
+        parsed.merge(histogram);
+        REQUIRE(parsed.total_count() == 6);
+
+        REQUIRE_THROWS_AS(Benchmarking::LatencyHistogram::parse("HDR 3 1 1000 0 0 5-1"), std::invalid_argument);
+        REQUIRE_THROWS_AS(Benchmarking::LatencyHistogram::parse("not a histogram"), std::invalid_argument);
+    }
+}
+
+TEST_CASE("measure records latencies of every iteration")
+{
+    auto& recorder = Benchmarking::histogram_recorder();
+    recorder.is_enabled = true;
+    recorder.current.emplace(2);
+
+    FakeMeter meter{7};
+    int calls = 0;
+    Benchmarking::measure(meter, 1, [&] { ++calls; });
+
+    const auto histogram = *recorder.current;
+    recorder.is_enabled = false;
+    recorder.current.reset();
+
+    REQUIRE(calls == 7);
+    REQUIRE(histogram.total_count() == 7);
+    REQUIRE(histogram.significant_digits() == 2);
+}
+
+TEST_CASE("tracer")
+{
+    auto& tracer = Benchmarking::Tracer::instance();
+    tracer.clear();
+
+    SECTION("disabled spans are not recorded")
+    {
+        {
+            Benchmarking::ScopedSpan span{"not traced"};
+        }
+
+        REQUIRE(tracer.no_of_events() == 0);
+    }
+
+    SECTION("spans of many threads in the Chrome trace format")
+    {
+        Benchmarking::Tracer::enable();
+        {
+            Benchmarking::ScopedSpan outer{"outer \"phase\""};
+
+            std::vector<std::thread> threads;
+            for (int i = 0; i < 3; ++i)
+                threads.emplace_back([] { Benchmarking::ScopedSpan span{"inner", "element"}; });
+            for (auto& thread : threads)
+                thread.join();
+        }
+        Benchmarking::Tracer::disable();
+
+        REQUIRE(tracer.no_of_events() == 4);
+
+        std::stringstream trace;
+        tracer.write_chrome_trace(trace);
+
+        boost::property_tree::ptree tree;
+        boost::property_tree::read_json(trace, tree);
+
+        std::vector<std::string> names;
+        std::set<std::string> thread_ids;
+        for (const auto& [key, event] : tree.get_child("traceEvents"))
+        {
+            if (event.get<std::string>("ph") != "X")
+                continue;
+
+            names.push_back(event.get<std::string>("name"));
+            thread_ids.insert(event.get<std::string>("tid"));
+            REQUIRE(event.get<double>("dur") >= 0.0);
+        }
+
+        std::sort(names.begin(), names.end());
+        REQUIRE(names == std::vector<std::string>{"inner", "inner", "inner", "outer \"phase\""});
+        REQUIRE(thread_ids.size() == 4);
+    }
+
+    SECTION("ring buffers keep the newest events")
+    {
+        Benchmarking::Tracer::enable();
+        std::thread{[] {
+            for (size_t i = 0; i < Benchmarking::Tracer::buffer_capacity + 10; ++i)
+                Benchmarking::ScopedSpan span{"event"};
+        }}.join();
+        Benchmarking::Tracer::disable();
+
+        REQUIRE(tracer.no_of_events() == Benchmarking::Tracer::buffer_capacity);
+    }
+
+    tracer.clear();
+}
+
+TEST_CASE("dataset generator")
+{
+    SECTION("the same seed gives the same data")
+    {
+        for (auto shape : Datasets::all_number_shapes)
+            REQUIRE(Datasets::generate_numbers(shape, 1000, {}, 42) == Datasets::generate_numbers(shape, 1000, {}, 42));
+
+        for (auto shape : Datasets::all_word_shapes)
+            REQUIRE(Datasets::generate_words(shape, 1000, 42) == Datasets::generate_words(shape, 1000, 42));
+    }
+
+    SECTION("a different seed gives different data")
+    {
+        REQUIRE(Datasets::generate_numbers(Datasets::NumberShape::uniform, 1000, {}, 1) != Datasets::generate_numbers(Datasets::NumberShape::uniform, 1000, {}, 2));
+        REQUIRE(Datasets::generate_words(Datasets::WordShape::random, 1000, 1) != Datasets::generate_words(Datasets::WordShape::random, 1000, 2));
+    }
+
+    SECTION("uniform_between covers the closed range")
+    {
+        Datasets::Engine engine{Datasets::default_seed};
+        std::vector<uint64_t> values;
+        for (int i = 0; i < 1000; ++i)
+            values.push_back(Datasets::uniform_between(engine, 10, 20));
+
+        REQUIRE(*std::min_element(values.begin(), values.end()) == 10);
+        REQUIRE(*std::max_element(values.begin(), values.end()) == 20);
+    }
+
+    SECTION("numbers")
+    {
+        const size_t size = 10'000;
+        const Datasets::NumbersOptions options{1000};
+
+        auto in_range = [&](const std::vector<uint64_t>& numbers) {
+            return numbers.size() == size && std::all_of(numbers.begin(), numbers.end(), [&](auto n) { return n <= options.max_value; });
+        };
+
+        for (auto shape : Datasets::all_number_shapes)
+            REQUIRE(in_range(Datasets::generate_numbers(shape, size, options)));
+
+        const auto sorted = Datasets::generate_numbers(Datasets::NumberShape::sorted, size, options);
+        REQUIRE(std::is_sorted(sorted.begin(), sorted.end()));
+
+        const auto reversed = Datasets::generate_numbers(Datasets::NumberShape::reverse_sorted, size, options);
+        REQUIRE(std::is_sorted(reversed.rbegin(), reversed.rend()));
+
+        const auto nearly_sorted = Datasets::generate_numbers(Datasets::NumberShape::nearly_sorted, size, options);
+        REQUIRE_FALSE(std::is_sorted(nearly_sorted.begin(), nearly_sorted.end()));
+        size_t no_of_descents = 0;
+        for (size_t i = 1; i < size; ++i)
+            no_of_descents += nearly_sorted[i - 1] > nearly_sorted[i];
+        REQUIRE(no_of_descents <= 2 * static_cast<size_t>(options.swapped_fraction * size));
+
+        const auto few_unique = Datasets::generate_numbers(Datasets::NumberShape::few_unique, size, options);
+        REQUIRE(std::set<uint64_t>(few_unique.begin(), few_unique.end()).size() <= options.no_of_unique_values);
+
+        const auto large_primes = Datasets::generate_numbers(Datasets::NumberShape::large_primes, size, options);
+        REQUIRE(std::all_of(large_primes.begin(), large_primes.end(), [&](auto n) { return n > options.max_value / 2 && Primes::is_prime(n); }));
+        REQUIRE_THROWS_AS(Datasets::generate_numbers(Datasets::NumberShape::large_primes, 1, {1}), std::invalid_argument);
+        REQUIRE(Datasets::generate_numbers(Datasets::NumberShape::large_primes, 3, {2}) == std::vector<uint64_t>{2, 2, 2});
+
+        // the smallest values are the most frequent ones
+        const auto zipf = Datasets::generate_numbers(Datasets::NumberShape::zipf, size, options);
+        const auto no_of_zeros = std::count(zipf.begin(), zipf.end(), 0);
+        const auto no_of_ones = std::count(zipf.begin(), zipf.end(), 1);
+        const auto no_of_large = std::count_if(zipf.begin(), zipf.end(), [](auto n) { return n >= 500; });
+        REQUIRE(no_of_zeros > no_of_ones);
+        REQUIRE(no_of_ones > 0);
+        REQUIRE(no_of_zeros > no_of_large);
+    }
+
+    SECTION("zipf distribution")
+    {
+        const Datasets::ZipfDistribution zipf{10, 1.0};
+        Datasets::Engine engine{Datasets::default_seed};
+
+        std::array<size_t, 11> counts{};
+        for (int i = 0; i < 100'000; ++i)
+        {
+            const auto rank = zipf(engine);
+            REQUIRE((rank >= 1 && rank <= 10));
+            ++counts[rank];
+        }
+
+        // p(1) / p(2) == 2 for the exponent 1
+        REQUIRE(static_cast<double>(counts[1]) / counts[2] == Approx(2.0).epsilon(0.05));
+        REQUIRE(static_cast<double>(counts[1]) / counts[10] == Approx(10.0).epsilon(0.1));
+    }
+
+    SECTION("words")
+    {
+        const size_t size = 10'000;
+
+        Datasets::WordsOptions options;
+        options.min_length = 3;
+        options.max_length = 7;
+        options.uppercase_fraction = 0.0;
+
+        const auto words = Datasets::generate_words(size, options);
+        REQUIRE(words.size() == size);
+        REQUIRE(std::all_of(words.begin(), words.end(), [](const auto& w) {
+            return w.size() >= 3 && w.size() <= 7 && std::all_of(w.begin(), w.end(), [](char c) { return c >= 'a' && c <= 'z'; });
+        }));
+
+        options.lengths = Datasets::LengthShape::fixed;
+        const auto fixed = Datasets::generate_words(size, options);
+        REQUIRE(std::all_of(fixed.begin(), fixed.end(), [](const auto& w) { return w.size() == 7; }));
+
+        options.max_length = 2;
+        REQUIRE_THROWS_AS(Datasets::generate_words(size, options), std::invalid_argument);
+
+        const auto long_words = Datasets::generate_words(Datasets::WordShape::long_words, size);
+        REQUIRE(std::all_of(long_words.begin(), long_words.end(), [](const auto& w) { return w.size() >= 32; }));
+
+        const auto few_unique = Datasets::generate_words(Datasets::WordShape::few_unique, size);
+        REQUIRE(std::set<std::string>(few_unique.begin(), few_unique.end()).size() <= 64);
+
+        // most words share one of a few prefixes
+        const auto prefix_options = Datasets::words_options(Datasets::WordShape::shared_prefixes);
+        const auto prefixed = Datasets::generate_words(Datasets::WordShape::shared_prefixes, size);
+        std::set<std::string> prefixes;
+        for (const auto& word : prefixed)
+            prefixes.insert(word.substr(0, prefix_options.prefix_length));
+
+        auto sorted_prefixed = prefixed;
+        std::sort(sorted_prefixed.begin(), sorted_prefixed.end());
+        size_t no_of_shared = 0;
+        for (size_t i = 1; i < size; ++i)
+            no_of_shared += sorted_prefixed[i - 1].compare(0, prefix_options.prefix_length, sorted_prefixed[i], 0, prefix_options.prefix_length) == 0;
+
+        REQUIRE(no_of_shared > size * 8 / 10);
+        REQUIRE(prefixes.size() < size / 5);
+
+        // natural lengths - short words are the most frequent
+        const auto natural = Datasets::generate_words(Datasets::WordShape::natural_lengths, size);
+        const auto no_of_short = std::count_if(natural.begin(), natural.end(), [](const auto& w) { return w.size() <= 4; });
+        REQUIRE(no_of_short > static_cast<long>(size / 2));
+    }
+}
+
+TEST_CASE("counter-based generator")
+{
+    SECTION("Philox4x32-10 known answers")
+    {
+        using Philox = Datasets::Philox4x32;
+
+        REQUIRE(Philox{Philox::Key{0, 0}}({0, 0, 0, 0}) == Philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+        REQUIRE(Philox{Philox::Key{0xffffffff, 0xffffffff}}({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff})
+            == Philox::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+        REQUIRE(Philox{Philox::Key{0xa4093822, 0x299f31d0}}({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344})
+            == Philox::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+    }
+
+    SECTION("streams are reproducible and independent")
+    {
+        auto draw = [](uint64_t seed, uint64_t stream) {
+            Datasets::CounterEngine engine{seed, stream};
+            std::vector<uint64_t> values(5);
+            std::generate(values.begin(), values.end(), engine);
+            return values;
+        };
+
+        REQUIRE(draw(1, 7) == draw(1, 7));
+        REQUIRE(draw(1, 7) != draw(1, 8));
+        REQUIRE(draw(1, 7) != draw(2, 7));
+
+        const auto values = draw(1, 7);
+        REQUIRE(std::set<uint64_t>(values.begin(), values.end()).size() == values.size());
+    }
+
+    SECTION("parallel_generate gives the same output for every policy")
+    {
+        const size_t size = 3 * Datasets::generate_chunk_size + 123;
+        auto make_value = [](Datasets::CounterEngine& engine) { return Datasets::uniform_between(engine, 0, 1000); };
+
+        std::vector<uint64_t> expected(size);
+        for (size_t chunk = 0; chunk * Datasets::generate_chunk_size < size; ++chunk)
+        {
+            Datasets::CounterEngine engine{42, chunk};
+            for (size_t i = chunk * Datasets::generate_chunk_size; i < std::min((chunk + 1) * Datasets::generate_chunk_size, size); ++i)
+                expected[i] = make_value(engine);
+        }
+
+        std::vector<uint64_t> sequenced(size), parallel(size), parallel_unsequenced(size);
+        Datasets::parallel_generate(std::execution::seq, sequenced.begin(), sequenced.end(), 42, make_value);
+        Datasets::parallel_generate(std::execution::par, parallel.begin(), parallel.end(), 42, make_value);
+        Datasets::parallel_generate(std::execution::par_unseq, parallel_unsequenced.begin(), parallel_unsequenced.end(), 42, make_value);
+
+        REQUIRE(sequenced == expected);
+        REQUIRE(parallel == expected);
+        REQUIRE(parallel_unsequenced == expected);
+
+        // a prefix of a dataset does not depend on its size
+        std::vector<uint64_t> shorter(1000);
+        Datasets::parallel_generate(std::execution::par, shorter.begin(), shorter.end(), 42, make_value);
+        REQUIRE(std::equal(shorter.begin(), shorter.end(), expected.begin()));
+    }
+
+    SECTION("generated numbers do not depend on the policy")
+    {
+        for (auto shape : Datasets::all_number_shapes)
+            REQUIRE(Datasets::generate_numbers(std::execution::par, shape, 50'000) == Datasets::generate_numbers(shape, 50'000));
+    }
+}
+
+TEST_CASE("fixture registry")
+{
+    Benchmarking::FixtureRegistry registry;
+    std::atomic<int> no_of_builds{0};
+
+    registry.add<std::vector<int>>("numbers", [&] {
+        ++no_of_builds;
+        std::this_thread::sleep_for(10ms);
+        return std::vector<int>{1, 2, 3};
+    });
+
+    SECTION("fixtures are built on first use")
+    {
+        REQUIRE(no_of_builds == 0);
+        REQUIRE_FALSE(registry.is_built("numbers"));
+
+        REQUIRE(registry.get<std::vector<int>>("numbers") == std::vector{1, 2, 3});
+        REQUIRE(&registry.get<std::vector<int>>("numbers") == &registry.get<std::vector<int>>("numbers"));
+        REQUIRE(registry.is_built("numbers"));
+        REQUIRE(no_of_builds == 1);
+    }
+
+    SECTION("concurrent requests build a fixture once")
+    {
+        std::vector<std::thread> threads;
+        std::vector<const std::vector<int>*> addresses(8);
+        for (size_t i = 0; i < addresses.size(); ++i)
+            threads.emplace_back([&, i] { addresses[i] = &registry.get<std::vector<int>>("numbers"); });
+        for (auto& thd : threads)
+            thd.join();
+
+        REQUIRE(no_of_builds == 1);
+        REQUIRE(std::all_of(addresses.begin(), addresses.end(), [&](auto address) { return address == addresses.front(); }));
+    }
+
+    SECTION("prefetch builds on a background thread")
+    {
+        registry.prefetch_all();
+        registry.wait_for_prefetches();
+
+        REQUIRE(registry.is_built("numbers"));
+        REQUIRE(registry.get<std::vector<int>>("numbers").size() == 3);
+        REQUIRE(no_of_builds == 1);
+    }
+
+    SECTION("errors")
+    {
+        REQUIRE_THROWS_AS(registry.get<std::vector<int>>("unknown"), std::out_of_range);
+        REQUIRE_THROWS_AS(registry.get<std::vector<long>>("numbers"), std::invalid_argument);
+        REQUIRE_THROWS_AS(registry.add<int>("numbers", [] { return 1; }), std::invalid_argument);
+        REQUIRE(no_of_builds == 0);
+    }
+
+    SECTION("a failed build is tried again")
+    {
+        bool is_failing = true;
+        registry.add<std::string>("flaky", [&] {
+            if (is_failing)
+                throw std::runtime_error("not yet");
+            return "ready"s;
+        });
+
+        registry.prefetch("flaky");
+        registry.wait_for_prefetches();
+        REQUIRE_THROWS_AS(registry.get<std::string>("flaky"), std::runtime_error);
+
+        is_failing = false;
+        REQUIRE(registry.get<std::string>("flaky") == "ready");
+    }
+}
+
+TEST_CASE("adaptive policy")
+{
+    Concurrency::AdaptivePolicy adaptive;
+
+    // parallel execution pays 50 us to start and wins from 10 000 elements
+    Concurrency::AdaptivePolicy::CostModels models;
+    models[static_cast<size_t>(Concurrency::ExecutionKind::sequenced)] = {100.0, 10.0};
+    models[static_cast<size_t>(Concurrency::ExecutionKind::parallel)] = {50'000.0, 5.0};
+    models[static_cast<size_t>(Concurrency::ExecutionKind::parallel_unsequenced)] = {50'000.0, 5.1};
+    adaptive.set_models("work", models);
+
+    SECTION("the policy with the lowest predicted cost is chosen")
+    {
+        REQUIRE(adaptive.choose("work", 100) == Concurrency::ExecutionKind::sequenced);
+        REQUIRE(adaptive.choose("work", 9'000) == Concurrency::ExecutionKind::sequenced);
+        REQUIRE(adaptive.choose("work", 11'000) == Concurrency::ExecutionKind::parallel);
+        REQUIRE(adaptive.choose("work", 1'000'000) == Concurrency::ExecutionKind::parallel);
+    }
+
+    SECTION("uncalibrated workloads use the default threshold")
+    {
+        REQUIRE_FALSE(adaptive.is_calibrated("other"));
+        REQUIRE(adaptive.choose("other", 10) == Concurrency::ExecutionKind::sequenced);
+
+        const auto expected = std::thread::hardware_concurrency() > 1 ? Concurrency::ExecutionKind::parallel : Concurrency::ExecutionKind::sequenced;
+        REQUIRE(adaptive.choose("other", Concurrency::AdaptivePolicy::default_parallel_threshold) == expected);
+    }
+
+    SECTION("run passes the chosen standard policy")
+    {
+        auto policy_name = [](auto &&policy) -> std::string {
+            using Policy = std::decay_t<decltype(policy)>;
+            if constexpr (std::is_same_v<Policy, std::execution::sequenced_policy>)
+                return "seq";
+            else if constexpr (std::is_same_v<Policy, std::execution::parallel_policy>)
+                return "par";
+            else
+                return "other";
+        };
+
+        REQUIRE(adaptive.run("work", 100, policy_name) == "seq");
+        REQUIRE(adaptive.run("work", 100'000, policy_name) == "par");
+    }
+
+    SECTION("algorithms give the same results with every policy")
+    {
+        std::vector<int> data(20'000);
+        std::iota(data.rbegin(), data.rend(), 0);
+
+        for (size_t size : {size_t{100}, data.size()})
+        {
+            std::vector<int> items(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(size));
+
+            std::vector<int> squares(size);
+            Concurrency::transform({adaptive, "work"}, items.begin(), items.end(), squares.begin(), [](int x) { return x * 2; });
+            REQUIRE(squares.front() == 2 * items.front());
+
+            REQUIRE(Concurrency::transform_reduce({adaptive, "work"}, items.begin(), items.end(), 0LL, std::plus{}, [](int x) { return x; })
+                == std::accumulate(items.begin(), items.end(), 0LL));
+
+            Concurrency::sort({adaptive, "work"}, items.begin(), items.end());
+            REQUIRE(std::is_sorted(items.begin(), items.end()));
+
+            auto boundary = Concurrency::partition({adaptive, "work"}, items.begin(), items.end(), [](int x) { return x % 2 == 0; });
+            REQUIRE(std::is_partitioned(items.begin(), items.end(), [](int x) { return x % 2 == 0; }));
+            REQUIRE(static_cast<size_t>(boundary - items.begin()) == (size + 1) / 2);
+        }
+    }
+
+    SECTION("calibration fits a cost model for every policy")
+    {
+        Concurrency::AdaptivePolicy::CalibrationConfig config;
+        config.small_size = 1 << 8;
+        config.large_size = 1 << 14;
+        config.no_of_runs = 2;
+
+        adaptive.calibrate(
+            "sort", [](size_t size) { return Datasets::generate_numbers(Datasets::NumberShape::uniform, size); },
+            [](auto &&policy, auto &data) { std::sort(policy, data.begin(), data.end()); }, config);
+
+        REQUIRE(adaptive.is_calibrated("sort"));
+        for (auto kind : Concurrency::all_execution_kinds)
+            REQUIRE(adaptive.model("sort", kind)->per_element_ns > 0.0);
+    }
+
+    SECTION("profiles are saved and loaded")
+    {
+        std::stringstream profile;
+        adaptive.save(profile);
+
+        Concurrency::AdaptivePolicy loaded;
+        REQUIRE(loaded.load(profile));
+        REQUIRE(loaded.choose("work", 9'000) == Concurrency::ExecutionKind::sequenced);
+        REQUIRE(loaded.choose("work", 11'000) == Concurrency::ExecutionKind::parallel);
+        REQUIRE(loaded.model("work", Concurrency::ExecutionKind::parallel_unsequenced)->per_element_ns == 5.1);
+
+        std::stringstream other_machine{std::string(Concurrency::AdaptivePolicy::profile_header) + " 100000\nwork\tseq\t0\t0\n"};
+        REQUIRE_FALSE(loaded.load(other_machine));
+
+        std::stringstream malformed{"not a profile\n"};
+        REQUIRE_THROWS_AS(loaded.load(malformed), std::runtime_error);
+
+        REQUIRE_FALSE(loaded.load_profile("no_such_profile.txt"));
+        REQUIRE(loaded.profile_file_name() == "no_such_profile.txt");
+    }
+}
+
+TEST_CASE("string hashers")
+{
+    // every length takes a different path of wyhash: 0, 1..3, 4..16, 17..48, > 48 bytes
+    std::string text(200, ' ');
+    for (size_t i = 0; i < text.size(); ++i)
+        text[i] = static_cast<char>('a' + i * 7 % 26);
+
+    SECTION("hashes of prefixes of all lengths are distinct")
+    {
+        std::set<uint64_t> wyhashes, fnv1a_hashes;
+        for (size_t length = 0; length <= text.size(); ++length)
+        {
+            wyhashes.insert(Hashing::wyhash(text.data(), length));
+            fnv1a_hashes.insert(Hashing::fnv1a(text.data(), length));
+        }
+
+        REQUIRE(wyhashes.size() == text.size() + 1);
+        REQUIRE(fnv1a_hashes.size() == text.size() + 1);
+    }
+
+    SECTION("every byte changes the hash")
+    {
+        for (size_t length : {1, 3, 4, 8, 16, 17, 48, 49, 100})
+        {
+            const uint64_t hash = Hashing::wyhash(text.data(), length);
+            for (size_t i = 0; i < length; ++i)
+            {
+                auto changed = text.substr(0, length);
+                changed[i] ^= 1;
+                REQUIRE(Hashing::wyhash(changed.data(), length) != hash);
+            }
+        }
+    }
+
+    SECTION("hashes depend on the seed, not on the alignment")
+    {
+        REQUIRE(Hashing::WyHash{1}("token") != Hashing::WyHash{2}("token"));
+        REQUIRE(Hashing::Fnv1a{1}("token") != Hashing::Fnv1a{2}("token"));
+        REQUIRE(Hashing::WyHash{}("token") == Hashing::wyhash("token", 5));
+
+        std::string shifted = "x" + text;
+        REQUIRE(Hashing::wyhash(shifted.data() + 1, 100) == Hashing::wyhash(text.data(), 100));
+    }
+
+    SECTION("std::hash adaptor in unordered containers")
+    {
+        std::unordered_set<std::string, Hashing::StdHash<std::string>> words{"one", "two", "three", "two"};
+        REQUIRE(words.size() == 3);
+        REQUIRE(words.count("two") == 1);
+        REQUIRE(Hashing::StdHash<std::string>{}("two"s) == Hashing::StdHash<std::string>{}("two"sv));
+
+        std::unordered_map<std::string, int, Hashing::WyHash> counts;
+        for (const auto &word : {"a"s, "b"s, "a"s})
+            ++counts[word];
+        REQUIRE(counts.at("a") == 2);
+    }
+
+    SECTION("bulk hashing of a token column")
+    {
+        std::vector<std::string> tokens;
+        for (size_t i = 0; i < 3 * Hashing::bulk_chunk_size + 3; ++i)
+            tokens.push_back(text.substr(i % 50, i % 70));
+        const Corpus::TokenColumn column{tokens.begin(), tokens.end()};
+
+        std::vector<uint64_t> expected;
+        for (const auto &token : tokens)
+            expected.push_back(Hashing::WyHash{7}(token));
+
+        REQUIRE(Hashing::hash_tokens(column, Hashing::WyHash{7}) == expected);
+        REQUIRE(Hashing::hash_tokens(std::execution::par, column, Hashing::WyHash{7}) == expected);
+        REQUIRE(Hashing::hash_tokens(Corpus::TokenColumn{}).empty());
+    }
+}
+
+TEST_CASE("word count engine")
+{
+    const auto words = Corpus::tokenize("b a c a b a d e b a");
+    Concurrency::ThreadPool pool{4};
+
+    SECTION("sequenced and parallel counts are equal")
+    {
+        const Corpus::WordCounts expected{{"a", 4}, {"b", 3}, {"c", 1}, {"d", 1}, {"e", 1}};
+
+        REQUIRE(Corpus::count_words(words.begin(), words.end()) == expected);
+        REQUIRE(Corpus::count_words(pool, words.begin(), words.end()) == expected);
+        REQUIRE(Corpus::count_words(pool, words.begin(), words.begin()).empty());
+
+        const Corpus::TokenColumn column{words.begin(), words.end()};
+        REQUIRE(Corpus::count_words(pool, column.begin(), column.end()) == expected);
+    }
+
+    SECTION("results sorted by frequency")
+    {
+        using WF = Corpus::WordFrequency;
+
+        REQUIRE(Corpus::count_words_by_frequency(pool, words.begin(), words.end())
+            == std::vector<WF>{{"a", 4}, {"b", 3}, {"c", 1}, {"d", 1}, {"e", 1}});
+        REQUIRE(Corpus::count_words_by_frequency(pool, words.begin(), words.end(), 3) == std::vector<WF>{{"a", 4}, {"b", 3}, {"c", 1}});
+    }
+
+    SECTION("large generated corpus")
+    {
+        const auto generated = Datasets::generate_words(Datasets::WordShape::natural_lengths, 100'000);
+
+        std::unordered_map<std::string_view, uint64_t> expected;
+        for (const auto &word : generated)
+            ++expected[word];
+
+        const auto counts = Corpus::count_words(pool, generated.begin(), generated.end());
+        REQUIRE(counts.size() == expected.size());
+        REQUIRE(std::all_of(expected.begin(), expected.end(), [&](const auto &entry) { return counts.at(entry.first) == entry.second; }));
+    }
+}
+
+TEST_CASE("sharded hash map")
+{
+    Concurrency::ShardedHashMap<int> map{4};
+
+    SECTION("insert_or_update inserts the value or updates the existing one")
+    {
+        REQUIRE(map.insert_or_update("one", 1, [](int &value) { value += 10; }));
+        REQUIRE_FALSE(map.insert_or_update("one", 1, [](int &value) { value += 10; }));
+        REQUIRE(map.find("one") == 11);
+
+        REQUIRE(map.insert("two", 2));
+        REQUIRE_FALSE(map.insert("two", 3));
+        REQUIRE(map.find("two") == 2);
+        REQUIRE(map.size() == 2);
+    }
+
+    SECTION("lookups by string_view of a temporary buffer")
+    {
+        std::string key = "token";
+        map.insert(key, 1);
+        key[0] = 'T'; // the map owns a copy of the key
+
+        REQUIRE(map.contains("token"sv));
+        REQUIRE_FALSE(map.contains(key));
+        REQUIRE(map.find(std::string_view{"tokens"}.substr(0, 5)) == 1);
+        REQUIRE(map.find("missing") == std::nullopt);
+    }
+
+    SECTION("erase and clear")
+    {
+        map.insert("a", 1);
+        map.insert("b", 2);
+
+        REQUIRE(map.erase("a"));
+        REQUIRE_FALSE(map.erase("a"));
+        REQUIRE(map.size() == 1);
+
+        map.clear();
+        REQUIRE(map.empty());
+    }
+
+    SECTION("concurrent writers and readers")
+    {
+        const auto words = Datasets::generate_words(Datasets::WordShape::few_unique, 40'000);
+        Concurrency::ShardedHashMap<uint64_t> counts{8};
+        std::atomic<bool> is_done{false};
+        std::atomic<size_t> no_of_zero_counts{0}; // Catch assertions are not thread-safe
+
+        std::thread reader{[&] {
+            while (!is_done)
+                counts.visit(words.front(), [&](uint64_t count) { no_of_zero_counts += count == 0; });
+        }};
+
+        std::vector<std::thread> writers;
+        for (size_t w = 0; w < 4; ++w)
+            writers.emplace_back([&, w] {
+                for (size_t i = w; i < words.size(); i += 4)
+                    counts.insert_or_update(words[i], 1, [](uint64_t &count) { ++count; });
+            });
+        for (auto &writer : writers)
+            writer.join();
+
+        is_done = true;
+        reader.join();
+        REQUIRE(no_of_zero_counts == 0);
+
+        std::unordered_map<std::string, uint64_t> expected;
+        for (const auto &word : words)
+            ++expected[word];
+
+        REQUIRE(counts.size() == expected.size());
+
+        std::mutex mtx_visited;
+        std::map<std::string, uint64_t> visited;
+        counts.for_each(std::execution::par, [&](std::string_view word, uint64_t count) {
+            std::lock_guard lk{mtx_visited};
+            visited.emplace(word, count);
+        });
+
+        REQUIRE(visited == std::map<std::string, uint64_t>(expected.begin(), expected.end()));
+    }
+}
+
+namespace
+{
+    // keys "1", "2", ... with Zipf frequencies - a skewed stream like natural text
+    std::vector<std::string> zipf_keys(size_t size, uint64_t no_of_keys, uint64_t seed)
+    {
+        const Datasets::ZipfDistribution zipf{no_of_keys, 1.1};
+        Datasets::Engine engine{seed};
+
+        std::vector<std::string> keys;
+        keys.reserve(size);
+        for (size_t i = 0; i < size; ++i)
+            keys.push_back(std::to_string(zipf(engine)));
+
+        return keys;
+    }
+}
+
+TEST_CASE("count-min sketch")
+{
+    const auto keys = zipf_keys(50'000, 5'000, 42);
+
+    std::unordered_map<std::string, uint64_t> exact_counts;
+    for (const auto &key : keys)
+        ++exact_counts[key];
+
+    SECTION("estimates never undercount")
+    {
+        Sketches::CountMinSketch sketch{256, 4};
+        std::unordered_map<std::string, uint64_t> running_counts;
+
+        size_t no_of_undercounts = 0;
+        for (const auto &key : keys)
+            no_of_undercounts += sketch.add(key) < ++running_counts[key];
+        REQUIRE(no_of_undercounts == 0);
+
+        REQUIRE(sketch.total_count() == keys.size());
+        REQUIRE(std::all_of(exact_counts.begin(), exact_counts.end(), [&](const auto &entry) { return sketch.estimate(entry.first) >= entry.second; }));
+    }
+
+    SECTION("exact when every key has its own counters")
+    {
+        Sketches::CountMinSketch sketch{1 << 20, 4};
+        for (const auto &key : keys)
+            sketch.add(key);
+
+        REQUIRE(std::all_of(exact_counts.begin(), exact_counts.end(), [&](const auto &entry) { return sketch.estimate(entry.first) == entry.second; }));
+        REQUIRE(sketch.estimate("missing") == 0);
+    }
+
+    SECTION("conservative update - errors within epsilon * total count")
+    {
+        auto sketch = Sketches::CountMinSketch::with_error(0.001, 0.01);
+        REQUIRE(sketch.width() == 2719);
+        REQUIRE(sketch.depth() == 5);
+        REQUIRE(sketch.memory_bytes() == 2719 * 5 * sizeof(uint64_t));
+
+        for (const auto &key : keys)
+            sketch.add(key);
+
+        size_t no_of_large_errors = 0;
+        for (const auto &[key, count] : exact_counts)
+            no_of_large_errors += sketch.estimate(key) - count > 0.001 * keys.size();
+        REQUIRE(no_of_large_errors <= exact_counts.size() / 100);
+
+        sketch.clear();
+        REQUIRE(sketch.total_count() == 0);
+        REQUIRE(sketch.estimate(keys.front()) == 0);
+    }
+
+    SECTION("merged sketches of parts of the stream never undercount the whole stream")
+    {
+        Sketches::CountMinSketch first_half{512, 4, 7};
+        Sketches::CountMinSketch second_half{512, 4, 7};
+        for (size_t i = 0; i < keys.size(); ++i)
+            (i < keys.size() / 2 ? first_half : second_half).add(keys[i]);
+
+        first_half.merge(second_half);
+
+        REQUIRE(first_half.total_count() == keys.size());
+        REQUIRE(std::all_of(exact_counts.begin(), exact_counts.end(), [&](const auto &entry) { return first_half.estimate(entry.first) >= entry.second; }));
+
+        REQUIRE_THROWS_AS(first_half.merge(Sketches::CountMinSketch{512, 4, 8}), std::invalid_argument);
+        REQUIRE_THROWS_AS(first_half.merge(Sketches::CountMinSketch{256, 4, 7}), std::invalid_argument);
+        REQUIRE_THROWS_AS(Sketches::CountMinSketch(0, 4), std::invalid_argument);
+        REQUIRE_THROWS_AS(Sketches::CountMinSketch::with_error(0.0, 0.1), std::invalid_argument);
+    }
+}
+
+TEST_CASE("space-saving top-k")
+{
+    SECTION("exact while all keys fit")
+    {
+        Sketches::SpaceSaving top_k{8};
+        for (const auto &word : Corpus::tokenize("b a c a b a d e b a"))
+            top_k.add(word);
+
+        REQUIRE(top_k.size() == 5);
+        REQUIRE(!top_k.is_full());
+        REQUIRE(top_k.min_count() == 0);
+        REQUIRE(top_k.total_count() == 10);
+
+        const auto top = top_k.top(3);
+        REQUIRE(top.size() == 3);
+        REQUIRE((top[0].key == "a" && top[0].count == 4 && top[0].error == 0));
+        REQUIRE((top[1].key == "b" && top[1].count == 3 && top[1].error == 0));
+        REQUIRE((top[2].key == "c" && top[2].count == 1 && top[2].error == 0));
+        REQUIRE(top_k.estimate("f") == 0);
+    }
+
+    const auto keys = zipf_keys(50'000, 5'000, 665);
+
+    std::unordered_map<std::string, uint64_t> exact_counts;
+    for (const auto &key : keys)
+        ++exact_counts[key];
+
+    auto check_bounds = [&](const Sketches::SpaceSaving &top_k) {
+        REQUIRE(top_k.total_count() == keys.size());
+
+        for (const auto &counter : top_k.top(top_k.capacity()))
+        {
+            const auto exact = exact_counts.at(counter.key);
+            REQUIRE(counter.count - counter.error <= exact);
+            REQUIRE(exact <= counter.count);
+        }
+
+        // every key more frequent than total / capacity is monitored
+        for (const auto &[key, count] : exact_counts)
+            if (count > keys.size() / top_k.capacity())
+                REQUIRE(top_k.estimate(key) >= count);
+    };
+
+    SECTION("counts bound the exact counts, heavy hitters are monitored")
+    {
+        Sketches::SpaceSaving top_k{100};
+        for (const auto &key : keys)
+            top_k.add(key);
+
+        REQUIRE(top_k.is_full());
+        check_bounds(top_k);
+
+        REQUIRE(top_k.top(1).front().key == "1");
+    }
+
+    SECTION("merged summaries of parts of the stream")
+    {
+        Sketches::SpaceSaving first_half{100};
+        Sketches::SpaceSaving second_half{100};
+        for (size_t i = 0; i < keys.size(); ++i)
+            (i < keys.size() / 2 ? first_half : second_half).add(keys[i]);
+
+        first_half.merge(second_half);
+
+        REQUIRE(first_half.size() == 100);
+        check_bounds(first_half);
+    }
+
+    SECTION("copies are independent")
+    {
+        Sketches::SpaceSaving top_k{4};
+        for (const auto &word : {"a"s, "b"s, "a"s})
+            top_k.add(word);
+
+        auto copy = top_k;
+        copy.add("c");
+        copy.add("b");
+
+        REQUIRE(top_k.size() == 2);
+        REQUIRE(copy.size() == 3);
+        REQUIRE(copy.estimate("b") == 2);
+        REQUIRE(top_k.estimate("b") == 1);
+
+        top_k = copy;
+        REQUIRE(top_k.estimate("c") == 1);
+
+        REQUIRE_THROWS_AS(Sketches::SpaceSaving{0}, std::invalid_argument);
+    }
+}
+
+TEST_CASE("hyperloglog")
+{
+    auto numbered_keys = [](size_t first, size_t last) {
+        std::vector<std::string> keys;
+        for (size_t i = first; i < last; ++i)
+            keys.push_back("key-" + std::to_string(i));
+        return keys;
+    };
+
+    SECTION("small counts are practically exact in the sparse representation")
+    {
+        Sketches::HyperLogLog<> sketch;
+        REQUIRE(sketch.estimate() == 0);
+
+        for (const auto &key : numbered_keys(0, 1'000))
+            sketch.add(key);
+        for (const auto &key : numbered_keys(0, 1'000))
+            sketch.add(key);
+
+        REQUIRE(sketch.is_sparse());
+        REQUIRE(sketch.estimate() == Approx(1'000).margin(2));
+        REQUIRE(sketch.memory_bytes() <= size_t{1} << sketch.precision());
+    }
+
+    SECTION("large counts within a few standard errors")
+    {
+        for (uint8_t precision : {8, 12, 14})
+        {
+            Sketches::HyperLogLog<> sketch{precision};
+            for (const auto &key : numbered_keys(0, 300'000))
+                sketch.add(key);
+
+            REQUIRE(!sketch.is_sparse());
+            REQUIRE(sketch.memory_bytes() == size_t{1} << precision);
+            REQUIRE(sketch.estimate() == Approx(300'000).epsilon(3 * sketch.standard_error()));
+        }
+    }
+
+    SECTION("pluggable hasher")
+    {
+        const auto keys = numbered_keys(0, 100'000);
+
+        const auto sketch = Sketches::count_distinct(keys.begin(), keys.end(), 12, Hashing::WyHash{42});
+        REQUIRE(sketch.hasher().seed == 42);
+        REQUIRE(sketch.estimate() == Approx(100'000).epsilon(3 * sketch.standard_error()));
+
+        Sketches::HyperLogLog<Hashing::StdHash<std::string>> std_hash_sketch{12};
+        for (const auto &key : keys)
+            std_hash_sketch.add(key);
+        REQUIRE(std_hash_sketch.estimate() == Sketches::count_distinct(keys.begin(), keys.end(), 12).estimate());
+
+        const auto fnv1a_sketch = Sketches::count_distinct(keys.begin(), keys.end(), 12, Hashing::Fnv1a{});
+        REQUIRE(fnv1a_sketch.estimate() == Approx(100'000).epsilon(3 * fnv1a_sketch.standard_error()));
+
+        Sketches::HyperLogLog<> hashed{12};
+        for (const auto hash : Hashing::hash_tokens(Corpus::TokenColumn{keys.begin(), keys.end()}))
+            hashed.add_hash(hash);
+        REQUIRE(hashed.estimate() == std_hash_sketch.estimate());
+    }
+
+    SECTION("merged sketches equal the sketch of the whole stream")
+    {
+        const auto keys = numbered_keys(0, 50'000);
+
+        for (size_t split : {100, 25'000})
+        {
+            Sketches::HyperLogLog<> whole{12}, first_part{12}, second_part{12};
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                whole.add(keys[i]);
+                (i < split ? first_part : second_part).add(keys[i]);
+            }
+
+            auto merged = first_part;
+            merged.merge(second_part);
+            REQUIRE(merged.estimate() == whole.estimate());
+
+            merged = second_part;
+            merged.merge(first_part);
+            REQUIRE(merged.estimate() == whole.estimate());
+        }
+
+        Sketches::HyperLogLog<> a{10}, b{10};
+        a.add("x");
+        b.add("x");
+        b.add("y");
+        a.merge(b);
+        a.merge(a);
+        REQUIRE(a.is_sparse());
+        REQUIRE(a.estimate() == 2);
+
+        REQUIRE_THROWS_AS(a.merge(Sketches::HyperLogLog<>{11}), std::invalid_argument);
+        REQUIRE_THROWS_AS(Sketches::HyperLogLog<>{3}, std::invalid_argument);
+        REQUIRE_THROWS_AS(Sketches::HyperLogLog<>{19}, std::invalid_argument);
+    }
+
+    SECTION("per-thread sketches merged by register max")
+    {
+        const auto words = Datasets::generate_words(Datasets::WordShape::natural_lengths, 200'000);
+        Concurrency::ThreadPool pool{4};
+
+        const auto sketch = Sketches::count_distinct(words.begin(), words.end());
+        REQUIRE(Sketches::count_distinct(pool, words.begin(), words.end()).estimate() == sketch.estimate());
+        REQUIRE(Sketches::count_distinct(pool, words.begin(), words.begin()).estimate() == 0);
+
+        const std::unordered_set<std::string> exact(words.begin(), words.end());
+        REQUIRE(sketch.estimate() == Approx(exact.size()).epsilon(3 * sketch.standard_error()));
+    }
+
+    SECTION("serialized form")
+    {
+        for (size_t no_of_keys : {0, 10, 1'000, 100'000})
+        {
+            Sketches::HyperLogLog<> sketch{12};
+            for (const auto &key : numbered_keys(0, no_of_keys))
+                sketch.add(key);
+
+            const auto bytes = sketch.serialize();
+            const auto loaded = Sketches::HyperLogLog<>::deserialize(bytes);
+
+            REQUIRE(loaded.precision() == 12);
+            REQUIRE(loaded.is_sparse() == sketch.is_sparse());
+            REQUIRE(loaded.estimate() == sketch.estimate());
+            REQUIRE(loaded.serialize() == bytes);
+            REQUIRE(bytes.size() <= 64 + (size_t{1} << 12));
+        }
+
+        REQUIRE_THROWS_AS(Sketches::HyperLogLog<>::deserialize(""), std::runtime_error);
+        REQUIRE_THROWS_AS(Sketches::HyperLogLog<>::deserialize("hyperloglog 1 12 dense 4096\n\x01\x02"), std::runtime_error);
+        REQUIRE_THROWS_AS(Sketches::HyperLogLog<>::deserialize("hyperloglog 1 12 sparse 2\n\x41\x00"), std::runtime_error);
+        REQUIRE_THROWS_AS(Sketches::HyperLogLog<>::deserialize("hyperloglog 1 30 sparse 0\n"), std::runtime_error);
+    }
+}
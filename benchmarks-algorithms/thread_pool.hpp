@@ -0,0 +1,626 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Concurrency
+{
+    class Task
+    {
+    public:
+        virtual ~Task() = default;
+        virtual void execute() = 0;
+    };
+
+    template <typename Func>
+    class FunctionTask : public Task
+    {
+        Func f_;
+
+    public:
+        explicit FunctionTask(Func f)
+            : f_{std::move(f)}
+        {
+        }
+
+        void execute() override
+        {
+            f_();
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli - "Correct and Efficient
+    // Work-Stealing for Weak Memory Models", 2013)
+    // - the owner pushes and pops at the bottom (LIFO), thieves steal from the top (FIFO)
+
+    class ChaseLevDeque
+    {
+        class RingBuffer
+        {
+            int64_t mask_;
+            std::unique_ptr<std::atomic<Task*>[]> items_;
+
+        public:
+            explicit RingBuffer(int64_t capacity)
+                : mask_{capacity - 1}
+                , items_{new std::atomic<Task*>[static_cast<size_t>(capacity)]()}
+            {
+            }
+
+            int64_t capacity() const
+            {
+                return mask_ + 1;
+            }
+
+            Task* get(int64_t index) const
+            {
+                return items_[static_cast<size_t>(index & mask_)].load(std::memory_order_relaxed);
+            }
+
+            void put(int64_t index, Task* task)
+            {
+                items_[static_cast<size_t>(index & mask_)].store(task, std::memory_order_relaxed);
+            }
+        };
+
+        alignas(64) std::atomic<int64_t> top_{0};
+        alignas(64) std::atomic<int64_t> bottom_{0};
+        std::atomic<RingBuffer*> buffer_;
+        std::vector<std::unique_ptr<RingBuffer>> buffers_; // retired buffers stay alive - a thief may still read from them
+
+        RingBuffer* grow(RingBuffer* buffer, int64_t bottom, int64_t top)
+        {
+            auto bigger = std::make_unique<RingBuffer>(buffer->capacity() * 2);
+
+            for (int64_t i = top; i < bottom; ++i)
+                bigger->put(i, buffer->get(i));
+
+            buffers_.push_back(std::move(bigger));
+            return buffers_.back().get();
+        }
+
+    public:
+        explicit ChaseLevDeque(int64_t capacity = 1024)
+        {
+            int64_t power_of_2 = 1;
+            while (power_of_2 < capacity)
+                power_of_2 *= 2;
+
+            buffers_.push_back(std::make_unique<RingBuffer>(power_of_2));
+            buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+        }
+
+        ChaseLevDeque(const ChaseLevDeque&) = delete;
+        ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+        // owner only
+        void push(Task* task)
+        {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const int64_t top = top_.load(std::memory_order_acquire);
+            RingBuffer* buffer = buffer_.load(std::memory_order_relaxed);
+
+            if (bottom - top > buffer->capacity() - 1)
+            {
+                buffer = grow(buffer, bottom, top);
+                buffer_.store(buffer, std::memory_order_release);
+            }
+
+            buffer->put(bottom, task);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // owner only - nullptr when empty
+        Task* pop()
+        {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            RingBuffer* buffer = buffer_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = top_.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            Task* task = buffer->get(bottom);
+
+            if (top == bottom) // last item - race against thieves
+            {
+                if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    task = nullptr;
+
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return task;
+        }
+
+        // any thread - nullptr when empty or when another thread won the race for the item
+        Task* steal()
+        {
+            int64_t top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return nullptr;
+
+            RingBuffer* buffer = buffer_.load(std::memory_order_acquire);
+            Task* task = buffer->get(top);
+
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+
+            return task;
+        }
+
+        size_t size() const
+        {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const int64_t top = top_.load(std::memory_order_relaxed);
+
+            return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // fork-join counter - ThreadPool::wait() helps running tasks until all tasks of the group are done
+
+    class TaskGroup
+    {
+        std::atomic<size_t> no_of_pending_{0};
+        std::mutex mtx_exception_;
+        std::exception_ptr exception_;
+
+        friend class ThreadPool;
+
+    public:
+        bool is_done() const
+        {
+            return no_of_pending_.load(std::memory_order_acquire) == 0;
+        }
+
+        void set_exception(std::exception_ptr exception)
+        {
+            std::lock_guard lk{mtx_exception_};
+            if (!exception_)
+                exception_ = std::move(exception);
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // work-stealing thread pool
+    // - every worker owns a Chase-Lev deque; tasks spawned on a worker go to its own deque
+    // - tasks spawned from other threads go to a shared injection queue
+    // - idle workers steal, then sleep on a condition variable until new tasks are queued
+
+    class ThreadPool
+    {
+        struct Worker
+        {
+            ChaseLevDeque deque;
+            std::thread thread;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+
+        std::mutex mtx_injected_;
+        std::deque<Task*> injected_;
+
+        std::atomic<int64_t> no_of_queued_{0};
+        std::atomic<int> no_of_sleeping_{0};
+        std::mutex mtx_sleep_;
+        std::condition_variable cv_sleep_;
+        std::atomic<bool> is_stopping_{false};
+
+        inline static thread_local ThreadPool* current_pool_ = nullptr;
+        inline static thread_local size_t current_worker_ = 0;
+
+        static constexpr int no_of_spins_before_sleep = 64;
+
+        bool is_worker_thread() const
+        {
+            return current_pool_ == this;
+        }
+
+        void push(Task* task)
+        {
+            if (is_worker_thread())
+            {
+                workers_[current_worker_]->deque.push(task);
+            }
+            else
+            {
+                std::lock_guard lk{mtx_injected_};
+                injected_.push_back(task);
+            }
+
+            no_of_queued_.fetch_add(1, std::memory_order_seq_cst);
+
+            if (no_of_sleeping_.load(std::memory_order_seq_cst) > 0)
+            {
+                std::lock_guard lk{mtx_sleep_};
+                cv_sleep_.notify_one();
+            }
+        }
+
+        Task* find_task()
+        {
+            const size_t no_of_workers = workers_.size();
+            const size_t first_victim = is_worker_thread() ? current_worker_ + 1 : 0;
+
+            if (is_worker_thread())
+            {
+                if (Task* task = workers_[current_worker_]->deque.pop())
+                    return task;
+            }
+
+            for (size_t i = 0; i < no_of_workers; ++i)
+            {
+                const size_t victim = (first_victim + i) % no_of_workers;
+
+                if (is_worker_thread() && victim == current_worker_)
+                    continue;
+
+                if (Task* task = workers_[victim]->deque.steal())
+                    return task;
+            }
+
+            std::lock_guard lk{mtx_injected_};
+            if (injected_.empty())
+                return nullptr;
+
+            Task* task = injected_.front();
+            injected_.pop_front();
+            return task;
+        }
+
+        void run_worker(size_t index)
+        {
+            current_pool_ = this;
+            current_worker_ = index;
+
+            int no_of_failed_attempts = 0;
+
+            while (!is_stopping_.load(std::memory_order_acquire))
+            {
+                if (try_run_one())
+                {
+                    no_of_failed_attempts = 0;
+                    continue;
+                }
+
+                if (++no_of_failed_attempts < no_of_spins_before_sleep)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock lk{mtx_sleep_};
+                no_of_sleeping_.fetch_add(1, std::memory_order_seq_cst);
+                cv_sleep_.wait(lk, [this] { return is_stopping_.load() || no_of_queued_.load(std::memory_order_seq_cst) > 0; });
+                no_of_sleeping_.fetch_sub(1, std::memory_order_seq_cst);
+                no_of_failed_attempts = 0;
+            }
+        }
+
+        static void pin_to_cpu([[maybe_unused]] std::thread& thread, [[maybe_unused]] size_t cpu)
+        {
+#ifdef __linux__
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &cpu_set);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpu_set);
+#endif
+        }
+
+    public:
+        explicit ThreadPool(size_t no_of_threads = std::max(1u, std::thread::hardware_concurrency()), bool pin_threads = false)
+        {
+            no_of_threads = std::max<size_t>(no_of_threads, 1);
+
+            for (size_t i = 0; i < no_of_threads; ++i)
+                workers_.push_back(std::make_unique<Worker>());
+
+            for (size_t i = 0; i < no_of_threads; ++i)
+            {
+                workers_[i]->thread = std::thread{[this, i] { run_worker(i); }};
+
+                if (pin_threads)
+                    pin_to_cpu(workers_[i]->thread, i);
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lk{mtx_sleep_};
+                is_stopping_.store(true);
+            }
+            cv_sleep_.notify_all();
+
+            for (auto& worker : workers_)
+                worker->thread.join();
+
+            for (auto& worker : workers_)
+                while (Task* task = worker->deque.pop())
+                    delete task;
+
+            for (Task* task : injected_)
+                delete task;
+        }
+
+        // one pool shared by every subsystem of the process
+        static ThreadPool& shared()
+        {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        size_t size() const
+        {
+            return workers_.size();
+        }
+
+        template <typename Func>
+        void spawn(TaskGroup& group, Func f)
+        {
+            group.no_of_pending_.fetch_add(1, std::memory_order_relaxed);
+
+            push(new FunctionTask{[&group, f = std::move(f)]() mutable {
+                try
+                {
+                    f();
+                }
+                catch (...)
+                {
+                    group.set_exception(std::current_exception());
+                }
+
+                group.no_of_pending_.fetch_sub(1, std::memory_order_release);
+            }});
+        }
+
+        bool try_run_one()
+        {
+            Task* task = find_task();
+
+            if (!task)
+                return false;
+
+            no_of_queued_.fetch_sub(1, std::memory_order_relaxed);
+
+            std::unique_ptr<Task> owned_task{task};
+            owned_task->execute();
+
+            return true;
+        }
+
+        // the waiting thread runs queued tasks instead of blocking - nested waits on workers cannot deadlock
+        void wait(TaskGroup& group)
+        {
+            while (!group.is_done())
+            {
+                if (!try_run_one())
+                    std::this_thread::yield();
+            }
+
+            if (group.exception_)
+                std::rethrow_exception(std::exchange(group.exception_, nullptr));
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////
+    // parallel algorithms on top of ThreadPool
+    // - grain_size == 0 selects ~8 chunks per worker
+
+    namespace Details
+    {
+        inline size_t default_grain_size(const ThreadPool& pool, size_t size)
+        {
+            return std::max<size_t>(1, size / (pool.size() * 8));
+        }
+
+        // the right half is spawned (and may be stolen), the left half is split further by the current thread
+        template <typename Index, typename RangeFunc>
+        void split_range(ThreadPool& pool, TaskGroup& group, Index first, Index last, size_t grain_size, const RangeFunc& body)
+        {
+            while (static_cast<size_t>(last - first) > grain_size)
+            {
+                const Index middle = first + (last - first) / 2;
+                pool.spawn(group, [&pool, &group, middle, last, grain_size, &body] { split_range(pool, group, middle, last, grain_size, body); });
+                last = middle;
+            }
+
+            body(first, last);
+        }
+    }
+
+    // body(first, last) is called for disjoint subranges covering [first, last)
+    template <typename Index, typename RangeFunc>
+    void parallel_for_range(ThreadPool& pool, Index first, Index last, RangeFunc body, size_t grain_size = 0)
+    {
+        static_assert(std::is_integral_v<Index>);
+
+        if (first >= last)
+            return;
+
+        if (grain_size == 0)
+            grain_size = Details::default_grain_size(pool, static_cast<size_t>(last - first));
+
+        TaskGroup group;
+
+        try
+        {
+            Details::split_range(pool, group, first, last, grain_size, body);
+        }
+        catch (...)
+        {
+            group.set_exception(std::current_exception());
+        }
+
+        pool.wait(group);
+    }
+
+    template <typename Index, typename Func>
+    void parallel_for(ThreadPool& pool, Index first, Index last, Func f, size_t grain_size = 0)
+    {
+        parallel_for_range(pool, first, last, [&f](Index chunk_first, Index chunk_last) {
+            for (Index i = chunk_first; i != chunk_last; ++i)
+                f(i);
+        }, grain_size);
+    }
+
+    template <typename RandomIt, typename OutputIt, typename UnaryOperation>
+    OutputIt parallel_transform(ThreadPool& pool, RandomIt first, RandomIt last, OutputIt d_first, UnaryOperation op, size_t grain_size = 0)
+    {
+        const auto size = std::distance(first, last);
+
+        parallel_for_range(pool, decltype(size){0}, size, [&](auto chunk_first, auto chunk_last) {
+            std::transform(first + chunk_first, first + chunk_last, d_first + chunk_first, op);
+        }, grain_size);
+
+        return d_first + size;
+    }
+
+    // partial results are combined in order of chunks - the result does not depend on scheduling
+    template <typename RandomIt, typename T, typename BinaryReduceOp, typename UnaryTransformOp>
+    T parallel_reduce(ThreadPool& pool, RandomIt first, RandomIt last, T init, BinaryReduceOp reduce, UnaryTransformOp transform, size_t grain_size = 0)
+    {
+        const auto size = static_cast<size_t>(std::distance(first, last));
+
+        if (size == 0)
+            return init;
+
+        if (grain_size == 0)
+            grain_size = Details::default_grain_size(pool, size);
+
+        const size_t no_of_chunks = (size + grain_size - 1) / grain_size;
+        std::vector<std::optional<T>> partial_results(no_of_chunks);
+
+        parallel_for(pool, size_t{0}, no_of_chunks, [&](size_t chunk) {
+            auto it = first + chunk * grain_size;
+            const auto chunk_last = first + std::min(size, (chunk + 1) * grain_size);
+
+            T partial_result = transform(*it);
+            for (++it; it != chunk_last; ++it)
+                partial_result = reduce(std::move(partial_result), transform(*it));
+
+            partial_results[chunk] = std::move(partial_result);
+        }, 1);
+
+        for (auto& partial_result : partial_results)
+            init = reduce(std::move(init), std::move(*partial_result));
+
+        return init;
+    }
+
+    // chunks are sorted in parallel, then merged pairwise in log2(no_of_chunks) parallel rounds
+    template <typename RandomIt, typename Compare = std::less<>>
+    void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp = {}, size_t grain_size = 0)
+    {
+        const auto size = static_cast<size_t>(std::distance(first, last));
+
+        if (size < 2)
+            return;
+
+        constexpr size_t min_grain_size = 2048;
+
+        if (grain_size == 0)
+            grain_size = std::max(min_grain_size, size / (pool.size() * 2));
+
+        size_t no_of_chunks = 1;
+        while (no_of_chunks * grain_size < size)
+            no_of_chunks *= 2;
+
+        auto bound = [=](size_t chunk) { return first + std::min(size, chunk * ((size + no_of_chunks - 1) / no_of_chunks)); };
+
+        parallel_for(pool, size_t{0}, no_of_chunks, [&](size_t chunk) {
+            std::sort(bound(chunk), bound(chunk + 1), comp);
+        }, 1);
+
+        for (size_t width = 1; width < no_of_chunks; width *= 2)
+        {
+            parallel_for(pool, size_t{0}, no_of_chunks / (2 * width), [&](size_t pair) {
+                const size_t left = pair * 2 * width;
+                std::inplace_merge(bound(left), bound(left + width), bound(left + 2 * width), comp);
+            }, 1);
+        }
+    }
+
+    // chunks are partitioned in parallel, then both halves of every chunk are moved to their final place in parallel
+    // requires a default constructible value_type
+    template <typename RandomIt, typename Predicate>
+    RandomIt parallel_partition(ThreadPool& pool, RandomIt first, RandomIt last, Predicate pred, size_t grain_size = 0)
+    {
+        using T = typename std::iterator_traits<RandomIt>::value_type;
+
+        const auto size = static_cast<size_t>(std::distance(first, last));
+
+        if (size == 0)
+            return first;
+
+        if (grain_size == 0)
+            grain_size = Details::default_grain_size(pool, size);
+
+        const size_t no_of_chunks = (size + grain_size - 1) / grain_size;
+        auto bound = [=](size_t chunk) { return std::min(size, chunk * grain_size); };
+
+        std::vector<size_t> no_of_trues(no_of_chunks);
+        parallel_for(pool, size_t{0}, no_of_chunks, [&](size_t chunk) {
+            const auto chunk_middle = std::partition(first + bound(chunk), first + bound(chunk + 1), pred);
+            no_of_trues[chunk] = static_cast<size_t>(chunk_middle - (first + bound(chunk)));
+        }, 1);
+
+        std::vector<size_t> true_offsets(no_of_chunks + 1);
+        std::partial_sum(no_of_trues.begin(), no_of_trues.end(), true_offsets.begin() + 1);
+        const size_t total_no_of_trues = true_offsets.back();
+
+        std::vector<T> partitioned(size);
+        parallel_for(pool, size_t{0}, no_of_chunks, [&](size_t chunk) {
+            const auto chunk_first = first + bound(chunk);
+            const auto chunk_middle = chunk_first + no_of_trues[chunk];
+            const size_t false_offset = total_no_of_trues + (bound(chunk) - true_offsets[chunk]);
+
+            std::move(chunk_first, chunk_middle, partitioned.begin() + true_offsets[chunk]);
+            std::move(chunk_middle, first + bound(chunk + 1), partitioned.begin() + false_offset);
+        }, 1);
+
+        parallel_for_range(pool, size_t{0}, size, [&](size_t chunk_first, size_t chunk_last) {
+            std::move(partitioned.begin() + chunk_first, partitioned.begin() + chunk_last, first + chunk_first);
+        }, grain_size);
+
+        return first + total_no_of_trues;
+    }
+}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef TOKEN_COLUMN_HPP
+#define TOKEN_COLUMN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Corpus
+{
+    ///////////////////////////////////////////////////////////////
+    // columnar token store - all bytes in one blob, token i is [offsets[i], offsets[i + 1])
+
+    class TokenColumn
+    {
+        std::vector<char> bytes_;
+        std::vector<uint32_t> offsets_{0};
+
+    public:
+        class const_iterator
+        {
+            const TokenColumn* column_ = nullptr;
+            std::ptrdiff_t index_ = 0;
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = std::string_view;
+
+            const_iterator() = default;
+
+            const_iterator(const TokenColumn* column, std::ptrdiff_t index)
+                : column_{column}
+                , index_{index}
+            {
+            }
+
+            reference operator*() const
+            {
+                return (*column_)[static_cast<size_t>(index_)];
+            }
+
+            reference operator[](difference_type n) const
+            {
+                return (*column_)[static_cast<size_t>(index_ + n)];
+            }
+
+            const_iterator& operator++()
+            {
+                ++index_;
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                auto temp = *this;
+                ++index_;
+                return temp;
+            }
+
+            const_iterator& operator--()
+            {
+                --index_;
+                return *this;
+            }
+
+            const_iterator operator--(int)
+            {
+                auto temp = *this;
+                --index_;
+                return temp;
+            }
+
+            const_iterator& operator+=(difference_type n)
+            {
+                index_ += n;
+                return *this;
+            }
+
+            const_iterator& operator-=(difference_type n)
+            {
+                index_ -= n;
+                return *this;
+            }
+
+            friend const_iterator operator+(const_iterator it, difference_type n)
+            {
+                return it += n;
+            }
+
+            friend const_iterator operator+(difference_type n, const_iterator it)
+            {
+                return it += n;
+            }
+
+            friend const_iterator operator-(const_iterator it, difference_type n)
+            {
+                return it -= n;
+            }
+
+            friend difference_type operator-(const const_iterator& a, const const_iterator& b)
+            {
+                return a.index_ - b.index_;
+            }
+
+            friend bool operator==(const const_iterator& a, const const_iterator& b)
+            {
+                return a.index_ == b.index_;
+            }
+
+            friend bool operator!=(const const_iterator& a, const const_iterator& b)
+            {
+                return a.index_ != b.index_;
+            }
+
+            friend bool operator<(const const_iterator& a, const const_iterator& b)
+            {
+                return a.index_ < b.index_;
+            }
+
+            friend bool operator>(const const_iterator& a, const const_iterator& b)
+            {
+                return a.index_ > b.index_;
+            }
+
+            friend bool operator<=(const const_iterator& a, const const_iterator& b)
+            {
+                return a.index_ <= b.index_;
+            }
+
+            friend bool operator>=(const const_iterator& a, const const_iterator& b)
+            {
+                return a.index_ >= b.index_;
+            }
+        };
+
+        TokenColumn() = default;
+
+        template <typename InputIterator>
+        TokenColumn(InputIterator first, InputIterator last)
+        {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIterator>::iterator_category>)
+            {
+                size_t no_of_bytes = 0;
+                for (auto it = first; it != last; ++it)
+                    no_of_bytes += std::string_view(*it).size();
+
+                reserve(static_cast<size_t>(std::distance(first, last)), no_of_bytes);
+            }
+
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        void reserve(size_t no_of_tokens, size_t no_of_bytes)
+        {
+            offsets_.reserve(no_of_tokens + 1);
+            bytes_.reserve(no_of_bytes);
+        }
+
+        void push_back(std::string_view token)
+        {
+            if (bytes_.size() + token.size() > std::numeric_limits<uint32_t>::max())
+                throw std::length_error("TokenColumn: more than 4 GiB of token bytes");
+
+            bytes_.insert(bytes_.end(), token.begin(), token.end());
+            offsets_.push_back(static_cast<uint32_t>(bytes_.size()));
+        }
+
+        std::string_view operator[](size_t index) const
+        {
+            return {bytes_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]};
+        }
+
+        size_t size() const
+        {
+            return offsets_.size() - 1;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        const_iterator begin() const
+        {
+            return {this, 0};
+        }
+
+        const_iterator end() const
+        {
+            return {this, static_cast<std::ptrdiff_t>(size())};
+        }
+
+        // the blob may be modified in place by transformations that keep token lengths (e.g. case folding)
+        char* data()
+        {
+            return bytes_.data();
+        }
+
+        const char* data() const
+        {
+            return bytes_.data();
+        }
+
+        std::string_view bytes() const
+        {
+            return {bytes_.data(), bytes_.size()};
+        }
+
+        const std::vector<uint32_t>& offsets() const
+        {
+            return offsets_;
+        }
+
+        std::vector<std::string_view> views() const
+        {
+            return std::vector<std::string_view>(begin(), end());
+        }
+
+        bool operator==(const TokenColumn& other) const
+        {
+            return offsets_ == other.offsets_ && bytes_ == other.bytes_;
+        }
+
+        bool operator!=(const TokenColumn& other) const
+        {
+            return !(*this == other);
+        }
+    };
+}
+
+#endif
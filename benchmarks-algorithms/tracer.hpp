@@ -0,0 +1,210 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace Benchmarking
+{
+    ///////////////////////////////////////////////////////////////
+    // scoped spans written to per-thread ring buffers - output in the Chrome trace event format (chrome://tracing, Perfetto)
+
+    struct TraceEvent
+    {
+        const char* name;     // string literals only - pointers are stored
+        const char* category;
+        int64_t start_ns;
+        int64_t duration_ns;
+    };
+
+    class Tracer
+    {
+    public:
+        static constexpr size_t buffer_capacity = 1 << 16; // the oldest events of a thread are overwritten
+
+    private:
+        // written only by the owning thread
+        struct ThreadBuffer
+        {
+            uint32_t thread_id;
+            std::vector<TraceEvent> events = std::vector<TraceEvent>(buffer_capacity);
+            std::atomic<uint64_t> no_of_events{0};
+
+            explicit ThreadBuffer(uint32_t id) : thread_id{id}
+            {
+            }
+        };
+
+        inline static std::atomic<bool> is_enabled_{false};
+
+        const std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+        mutable std::mutex mtx_buffers_;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers_; // buffers outlive their threads
+
+        Tracer() = default;
+
+        ThreadBuffer& current_buffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+            if (!buffer)
+            {
+                std::lock_guard lk{mtx_buffers_};
+                buffer = std::make_shared<ThreadBuffer>(static_cast<uint32_t>(buffers_.size()));
+                buffers_.push_back(buffer);
+            }
+
+            return *buffer;
+        }
+
+        static void write_escaped(std::ostream& out, const char* text)
+        {
+            for (; *text; ++text)
+            {
+                if (*text == '"' || *text == '\\')
+                    out << '\\';
+                out << *text;
+            }
+        }
+
+    public:
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        static Tracer& instance()
+        {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        // the only cost of a disabled span is this relaxed load
+        static bool is_enabled()
+        {
+            return is_enabled_.load(std::memory_order_relaxed);
+        }
+
+        static void enable()
+        {
+            instance();
+            is_enabled_.store(true, std::memory_order_relaxed);
+        }
+
+        static void disable()
+        {
+            is_enabled_.store(false, std::memory_order_relaxed);
+        }
+
+        int64_t now_ns() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+        }
+
+        void record(const char* name, const char* category, int64_t start_ns, int64_t end_ns)
+        {
+            auto& buffer = current_buffer();
+
+            const uint64_t index = buffer.no_of_events.load(std::memory_order_relaxed);
+            buffer.events[index % buffer_capacity] = {name, category, start_ns, end_ns - start_ns};
+            buffer.no_of_events.store(index + 1, std::memory_order_release);
+        }
+
+        // events kept in ring buffers
+        size_t no_of_events() const
+        {
+            std::lock_guard lk{mtx_buffers_};
+
+            size_t count = 0;
+            for (const auto& buffer : buffers_)
+                count += std::min<size_t>(buffer->no_of_events.load(std::memory_order_acquire), buffer_capacity);
+
+            return count;
+        }
+
+        // only while traced threads do not record
+        void clear()
+        {
+            std::lock_guard lk{mtx_buffers_};
+
+            for (const auto& buffer : buffers_)
+                buffer->no_of_events.store(0, std::memory_order_relaxed);
+        }
+
+        // complete ("X") events with a thread name per buffer - only while traced threads do not record
+        void write_chrome_trace(std::ostream& out) const
+        {
+            std::lock_guard lk{mtx_buffers_};
+
+            const auto precision = out.precision(15);
+            out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+            bool is_first = true;
+            auto separator = [&] {
+                out << (is_first ? "\n" : ",\n");
+                is_first = false;
+            };
+
+            for (const auto& buffer : buffers_)
+            {
+                const uint64_t no_of_events = buffer->no_of_events.load(std::memory_order_acquire);
+                if (no_of_events == 0)
+                    continue;
+
+                separator();
+                out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->thread_id
+                    << ", \"args\": {\"name\": \"thread " << buffer->thread_id << "\"}}";
+
+                const uint64_t first = no_of_events > buffer_capacity ? no_of_events - buffer_capacity : 0;
+                for (uint64_t i = first; i < no_of_events; ++i)
+                {
+                    const auto& event = buffer->events[i % buffer_capacity];
+
+                    separator();
+                    out << "{\"name\": \"";
+                    write_escaped(out, event.name);
+                    out << "\", \"cat\": \"";
+                    write_escaped(out, event.category);
+                    out << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->thread_id << ", \"ts\": " << event.start_ns / 1000.0
+                        << ", \"dur\": " << event.duration_ns / 1000.0 << "}";
+                }
+            }
+
+            out << "\n]}\n";
+            out.precision(precision);
+        }
+    };
+
+    class ScopedSpan
+    {
+        const char* name_;
+        const char* category_;
+        int64_t start_ns_ = -1;
+
+    public:
+        explicit ScopedSpan(const char* name, const char* category = "benchmark") : name_{name}, category_{category}
+        {
+            if (Tracer::is_enabled())
+                start_ns_ = Tracer::instance().now_ns();
+        }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+        ~ScopedSpan()
+        {
+            if (start_ns_ >= 0)
+            {
+                auto& tracer = Tracer::instance();
+                tracer.record(name_, category_, start_ns_, tracer.now_ns());
+            }
+        }
+    };
+}
+
+#endif
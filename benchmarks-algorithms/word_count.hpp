@@ -0,0 +1,130 @@
+#ifndef WORD_COUNT_HPP
+#define WORD_COUNT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "hashing.hpp"
+#include "thread_pool.hpp"
+
+namespace Corpus
+{
+    ///////////////////////////////////////////////////////////////
+    // word frequencies - keys are views of the counted tokens, which must outlive the counts
+
+    using WordCounts = std::unordered_map<std::string_view, uint64_t, Hashing::WyHash>;
+
+    struct WordFrequency
+    {
+        std::string_view word;
+        uint64_t count;
+
+        bool operator==(const WordFrequency& other) const
+        {
+            return word == other.word && count == other.count;
+        }
+    };
+
+    template <typename InputIt>
+    WordCounts count_words(InputIt first, InputIt last)
+    {
+        WordCounts counts;
+
+        for (; first != last; ++first)
+            ++counts[std::string_view(*first)];
+
+        return counts;
+    }
+
+    // every worker counts its chunk into a local table split into shards by hash, shards are merged in parallel
+    // - no locks and no shared writes while counting; the merge touches each distinct word of a chunk once
+    template <typename RandomIt>
+    WordCounts count_words(Concurrency::ThreadPool& pool, RandomIt first, RandomIt last)
+    {
+        const auto size = static_cast<size_t>(std::distance(first, last));
+
+        const size_t no_of_chunks = std::max<size_t>(1, std::min(pool.size(), size));
+        const size_t no_of_shards = no_of_chunks;
+        const Hashing::WyHash hasher;
+
+        // multiply-shift on the high bits - independent of the bucket index the tables compute from the same hash
+        auto shard_of = [&](std::string_view word) { return static_cast<size_t>(((hasher(word) >> 32) * no_of_shards) >> 32); };
+
+        std::vector<std::vector<WordCounts>> local_counts(no_of_chunks, std::vector<WordCounts>(no_of_shards));
+
+        Concurrency::parallel_for(pool, size_t{0}, no_of_chunks, [&](size_t chunk) {
+            auto& shards = local_counts[chunk];
+
+            const auto chunk_last = first + (chunk + 1) * size / no_of_chunks;
+            for (auto it = first + chunk * size / no_of_chunks; it != chunk_last; ++it)
+            {
+                const std::string_view word(*it);
+                ++shards[shard_of(word)][word];
+            }
+        }, 1);
+
+        std::vector<WordCounts> merged(no_of_shards);
+
+        Concurrency::parallel_for(pool, size_t{0}, no_of_shards, [&](size_t shard) {
+            auto& counts = merged[shard];
+            counts = std::move(local_counts[0][shard]);
+
+            for (size_t chunk = 1; chunk < no_of_chunks; ++chunk)
+                for (const auto& [word, count] : local_counts[chunk][shard])
+                    counts[word] += count;
+        }, 1);
+
+        if (no_of_shards == 1)
+            return std::move(merged.front());
+
+        // shards have disjoint keys
+        size_t no_of_words = 0;
+        for (const auto& counts : merged)
+            no_of_words += counts.size();
+
+        WordCounts counts;
+        counts.reserve(no_of_words);
+        for (auto& shard : merged)
+            counts.insert(shard.begin(), shard.end());
+
+        return counts;
+    }
+
+    // the most frequent words first, ties in lexicographical order - the order does not depend on the hash tables
+    inline std::vector<WordFrequency> by_frequency(const WordCounts& counts, size_t top = std::numeric_limits<size_t>::max())
+    {
+        std::vector<WordFrequency> frequencies;
+        frequencies.reserve(counts.size());
+        for (const auto& [word, count] : counts)
+            frequencies.push_back({word, count});
+
+        auto more_frequent = [](const WordFrequency& a, const WordFrequency& b) { return a.count != b.count ? a.count > b.count : a.word < b.word; };
+
+        if (top < frequencies.size())
+        {
+            std::partial_sort(frequencies.begin(), frequencies.begin() + static_cast<std::ptrdiff_t>(top), frequencies.end(), more_frequent);
+            frequencies.resize(top);
+        }
+        else
+        {
+            std::sort(frequencies.begin(), frequencies.end(), more_frequent);
+        }
+
+        return frequencies;
+    }
+
+    template <typename RandomIt>
+    std::vector<WordFrequency> count_words_by_frequency(Concurrency::ThreadPool& pool, RandomIt first, RandomIt last,
+        size_t top = std::numeric_limits<size_t>::max())
+    {
+        return by_frequency(count_words(pool, first, last), top);
+    }
+}
+
+#endif